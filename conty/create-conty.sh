@@ -56,7 +56,7 @@ settings_minimal () {
   /^PACKAGES=\(/ {
     print "PACKAGES=("
     print "    qt6-wayland qt6-webengine qt6-imageformats qt6-svg"
-    print "    python-pycurl python-tqdm python-cryptography python-beautifulsoup4 python-pillow"
+    print "    python-pycurl python-tqdm python-cryptography python-beautifulsoup4 python-pillow python-zstandard"
     print "    umu-launcher protontricks gamemode"
     print ")"
     skip=1
@@ -81,11 +81,11 @@ settings_build () {
     print "PACKAGES=("
     print "    base-devel cmake ccache meson"
     print "    qt6-wayland qt6-webengine qt6-imageformats qt6-svg"
-    print "    python-pycurl python-tqdm python-cryptography python-beautifulsoup4 python-pillow"
+    print "    python-pycurl python-tqdm python-cryptography python-beautifulsoup4 python-pillow python-zstandard"
     print "    umu-launcher protontricks wine-staging winetricks lutris steam gamemode"
     print "    lib32-vulkan-radeon vulkan-tools vulkan-headers"
     print "    kvantum qt6ct"
-    print "    curl glib2"
+    print "    curl glib2 zstd"
     print ")"
     skip=1
     next
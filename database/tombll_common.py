@@ -1,8 +1,22 @@
 """Common tombll database calls."""
+import os
 import sys
 import sqlite3
 import json
 import logging
+import struct
+
+import zstandard
+
+# Name of the shared zstd dictionary for Level.body and Level.walkthrough
+LEVEL_TEXT_DICTIONARY = 'level_text'
+ZSTD_MAGIC = b'\x28\xb5\x2f\xfd'
+
+# Picture pack next to tombll.db, magic, version 1 and the pack generation.
+# Generation 0 is pictures.pack, every -pc writes the next one.
+PICTURE_PACK = 'pictures.pack'
+PICTURE_PACK_MAGIC = b'TRLLPACK'
+PICTURE_PACK_VERSION = 1
 
 
 def get_tombll_json(path):
@@ -175,3 +189,185 @@ def make_empty_null(value):
     if value in ("", 0.0, 0):
         return None
     return value
+
+
+def get_level_text_dictionary(con):
+    """Get the shared zstd dictionary used for Level.body and Level.walkthrough.
+
+    Args:
+        con (sqlite3.Connection): SQLite database connection.
+
+    Returns:
+        zstandard.ZstdCompressionDict or None: The dictionary, None if the
+        database has none, then the text is stored uncompressed.
+    """
+    table = query_return_everything(
+        "SELECT name FROM sqlite_master WHERE type = 'table' AND name = 'Dictionary'",
+        None, con)
+    if not table:
+        return None
+    row = query_return_everything(
+        "SELECT data FROM Dictionary WHERE name = ?", (LEVEL_TEXT_DICTIONARY,), con)
+    if not row:
+        return None
+    return zstandard.ZstdCompressionDict(row[0][0])
+
+
+def compress_level_text(text, con, dictionary=None):
+    """Compress level HTML the way the launcher reads it.
+
+    Args:
+        text (str or None): Level body or walkthrough HTML.
+        con (sqlite3.Connection): SQLite database connection.
+        dictionary (zstandard.ZstdCompressionDict): Dictionary to use instead
+            of the one in the database.
+
+    Returns:
+        bytes or str: A zstd frame with the content size, or the text itself
+        if there is no dictionary or nothing to compress.
+    """
+    if not text:
+        return text
+    if dictionary is None:
+        dictionary = get_level_text_dictionary(con)
+        if dictionary is None:
+            return text
+    compressor = zstandard.ZstdCompressor(level=19, dict_data=dictionary)
+    return compressor.compress(text.encode('utf-8'))
+
+
+def decompress_level_text(value, con, dictionary=None):
+    """Read a Level.body or Level.walkthrough value as text.
+
+    Args:
+        value (bytes or str or None): The column value.
+        con (sqlite3.Connection): SQLite database connection.
+        dictionary (zstandard.ZstdCompressionDict): Dictionary to use instead
+            of the one in the database.
+
+    Returns:
+        str or None: The HTML text.
+    """
+    if not isinstance(value, bytes):
+        return value
+    if not value.startswith(ZSTD_MAGIC):
+        return value.decode('utf-8')
+    if dictionary is None:
+        dictionary = get_level_text_dictionary(con)
+    if dictionary is None:
+        decompressor = zstandard.ZstdDecompressor()
+    else:
+        decompressor = zstandard.ZstdDecompressor(dict_data=dictionary)
+    return decompressor.decompress(value).decode('utf-8')
+
+
+def index_level_text(level_id, body, walkthrough, con):
+    """Put the plain text of a level in the LevelSearch full-text index.
+
+    The launcher creates LevelSearch and its triggers, the triggers can't
+    index compressed text so the writer does it after writing the Level row.
+
+    Args:
+        level_id (int): The LevelID, also the LevelSearch rowid.
+        body (str or None): Level body HTML.
+        walkthrough (str or None): Level walkthrough HTML.
+        con (sqlite3.Connection): SQLite database connection.
+    """
+    table = query_return_everything(
+        "SELECT name FROM sqlite_master WHERE type = 'table' AND name = 'LevelSearch'",
+        None, con)
+    if table:
+        query_run(
+            "UPDATE LevelSearch SET body = ?, walkthrough = ? WHERE rowid = ?",
+            (body, walkthrough, level_id), con)
+
+
+def picture_pack_path(generation=0):
+    """Get the full path to a generation of the picture pack next to tombll.db."""
+    name = PICTURE_PACK if generation == 0 else f"pictures.{generation}.pack"
+    return os.path.join(os.path.dirname(os.path.abspath(__file__)), name)
+
+
+def picture_pack_header(generation=0):
+    """Get the header bytes of a generation of the picture pack."""
+    return PICTURE_PACK_MAGIC + struct.pack('<II', PICTURE_PACK_VERSION, generation)
+
+
+def picture_pack_generation(con):
+    """Get the pack generation the PicturePack offsets point into.
+
+    Args:
+        con (sqlite3.Connection): SQLite database connection.
+
+    Returns:
+        int: The generation from PicturePackFile, 0 before the first -pc.
+    """
+    if not query_return_everything(
+            "SELECT name FROM sqlite_master "
+            "WHERE type = 'table' AND name = 'PicturePackFile'", None, con):
+        return 0
+    row = query_return_everything("SELECT generation FROM PicturePackFile", None, con)
+    return row[0][0] if row else 0
+
+
+def picture_pack_enabled(con):
+    """Check if pictures are written to the picture pack.
+
+    Args:
+        con (sqlite3.Connection): SQLite database connection.
+
+    Returns:
+        bool: True if the PicturePack table exists, made by tombll_manage_data.py -pk.
+    """
+    return bool(query_return_everything(
+        "SELECT name FROM sqlite_master WHERE type = 'table' AND name = 'PicturePack'",
+        None, con))
+
+
+def picture_pack_append(md5sum, data, con):
+    """Append a picture to the pack, unless one with the same md5sum is there.
+
+    The data is synced to disk before the PicturePack row is written, so a
+    committed row always points at complete data. A crash can only leave
+    unreferenced bytes at the end, tombll_manage_data.py -pc drops them.
+
+    Args:
+        md5sum (str): Picture.md5sum of the data.
+        data (bytes): WEBP picture data.
+        con (sqlite3.Connection): SQLite database connection.
+    """
+    if query_return_everything(
+            "SELECT 1 FROM PicturePack WHERE md5sum = ?", (md5sum, ), con):
+        return
+
+    generation = picture_pack_generation(con)
+    with open(picture_pack_path(generation), mode='ab') as pack:
+        if pack.tell() == 0:
+            pack.write(picture_pack_header(generation))
+        offset = pack.tell()
+        pack.write(data)
+        pack.flush()
+        os.fsync(pack.fileno())
+
+    query_run(
+        "INSERT INTO PicturePack (md5sum, offset, size) VALUES (?, ?, ?)",
+        (md5sum, offset, len(data)), con)
+
+
+def picture_pack_read(md5sum, con):
+    """Read a picture from the pack.
+
+    Args:
+        md5sum (str): Picture.md5sum of the picture.
+        con (sqlite3.Connection): SQLite database connection.
+
+    Returns:
+        bytes or None: The picture data, None if it's not in the pack.
+    """
+    row = query_return_everything(
+        "SELECT offset, size FROM PicturePack WHERE md5sum = ?", (md5sum, ), con)
+    if not row:
+        return None
+    with open(picture_pack_path(picture_pack_generation(con)), mode='rb') as pack:
+        pack.seek(row[0][0])
+        return pack.read(row[0][1])
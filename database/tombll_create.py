@@ -237,6 +237,10 @@ def database_screen(picture, level_id, con):
 
     picture_id = tombll_common.query_return_id(query_select_id, (picture['md5sum'], ), con)
     if picture_id is None:
+        # Packed pictures keep an empty BLOB, the data goes in pictures.pack
+        if tombll_common.picture_pack_enabled(con):
+            tombll_common.picture_pack_append(picture['md5sum'], picture['data'], con)
+            arg = (picture['md5sum'], b'')
         picture_id = tombll_common.query_return_id(query_insert, arg, con)
 
     # Link the inserted picture to the specified level in the Screens table
@@ -290,13 +294,14 @@ def database_level(data, con):
 
     # Prepare arguments for the insertion, including the infoID from `add_info_to_database`
     arg = (
-        data.get('body'),                   # Level body content
-        data.get('walkthrough'),            # Level walkthrough content
+        tombll_common.compress_level_text(data.get('body'), con),         # Level body content
+        tombll_common.compress_level_text(data.get('walkthrough'), con),  # Level walkthrough
         database_info(data, con)  # Retrieve and create infoID
     )
 
     # Execute the query and get the ID of the inserted level
     level_id = tombll_common.query_return_id(query, arg, con)
+    tombll_common.index_level_text(level_id, data.get('body'), data.get('walkthrough'), con)
 
     # Log the current level ID for debugging or tracking purposes
     logging.info("Current tombll level_id: %s", level_id)
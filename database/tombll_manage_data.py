@@ -7,6 +7,8 @@ import json
 import time
 import logging
 
+import zstandard
+
 import scrape_trle
 import data_factory
 
@@ -35,6 +37,11 @@ Usage: python3 tombll_manage_data.py [options]
       -rm   [lid] Remove one level record
       -sc   Sync cards
       -u    [lid] Update a level record
+      -z    Train the level text dictionary and compress all level bodies
+                and walkthroughs with it
+      -pk   Move the pictures out of the database into pictures.pack
+      -pc   Compact the picture pack, drop pictures no level uses
+      -pv   Verify pictures.pack against the Picture md5sums
 
       -ld   [lid] List download files records
       -ad   [lid Zip.name Zip.size Zip.md5sum]
@@ -394,6 +401,204 @@ class TailSync:
         con.close()
 
 
+def compress_level_text():
+    """Train a shared zstd dictionary on the level HTML and compress it.
+
+    The dictionary is stored in the Dictionary table, Level.body and
+    Level.walkthrough are rewritten as zstd frames that the launcher
+    decompresses with it. Running it again retrains on the current text.
+    Prints the database size before and after and the decode time per page.
+    """
+    path = os.path.dirname(os.path.abspath(__file__)) + '/tombll.db'
+    size_before = os.path.getsize(path)
+    con = database_make_connection()
+    old_dictionary = tombll_common.get_level_text_dictionary(con)
+
+    levels = []
+    for level_id, body, walkthrough in tombll_common.query_return_everything(
+            "SELECT LevelID, body, walkthrough FROM Level", None, con):
+        levels.append((
+            level_id,
+            tombll_common.decompress_level_text(body, con, old_dictionary),
+            tombll_common.decompress_level_text(walkthrough, con, old_dictionary)))
+
+    samples = [text.encode('utf-8') for level in levels for text in level[1:] if text]
+    if len(samples) < 16:
+        logging.error("Not enough level text to train a dictionary: %s pages", len(samples))
+        con.close()
+        sys.exit(1)
+    dictionary = zstandard.train_dictionary(112640, samples, level=19)
+
+    database_begin_write(con)
+    tombll_common.query_run(
+        "CREATE TABLE IF NOT EXISTS Dictionary ("
+        "    DictionaryID INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL,"
+        "    name TEXT UNIQUE NOT NULL,"
+        "    data BLOB NOT NULL)", None, con)
+    tombll_common.query_run(
+        "INSERT OR REPLACE INTO Dictionary (name, data) VALUES (?, ?)",
+        (tombll_common.LEVEL_TEXT_DICTIONARY, dictionary.as_bytes()), con)
+
+    frames = []
+    for level_id, body, walkthrough in levels:
+        body_frame = tombll_common.compress_level_text(body, con, dictionary)
+        walkthrough_frame = tombll_common.compress_level_text(walkthrough, con, dictionary)
+        tombll_common.query_run(
+            "UPDATE Level SET body = ?, walkthrough = ? WHERE LevelID = ?",
+            (body_frame, walkthrough_frame, level_id), con)
+        tombll_common.index_level_text(level_id, body, walkthrough, con)
+        frames.extend(f for f in (body_frame, walkthrough_frame) if isinstance(f, bytes))
+    con.commit()
+    con.execute("VACUUM")
+    con.close()
+    size_after = os.path.getsize(path)
+
+    decompressor = zstandard.ZstdDecompressor(dict_data=dictionary)
+    start = time.perf_counter()
+    for frame in frames:
+        decompressor.decompress(frame)
+    elapsed = time.perf_counter() - start
+
+    print(f"Dictionary id {dictionary.dict_id()}, {len(dictionary.as_bytes())} bytes, "
+          f"trained on {len(samples)} pages")
+    print(f"Database size {size_before / 1048576:.1f} MiB -> {size_after / 1048576:.1f} MiB")
+    if frames:
+        print(f"Decode latency {elapsed * 1000000 / len(frames):.1f} us per page")
+
+
+def pack_pictures():
+    """Move all Picture.data BLOBs into the append-only picture pack.
+
+    Each picture is appended once per md5sum and its offset and size are
+    recorded in the PicturePack table, the BLOB is replaced by an empty one.
+    The database is vacuumed after, prints the sizes before and after.
+    """
+    path = os.path.dirname(os.path.abspath(__file__)) + '/tombll.db'
+    size_before = os.path.getsize(path)
+    con = database_make_connection()
+
+    database_begin_write(con)
+    tombll_common.query_run(
+        "CREATE TABLE IF NOT EXISTS PicturePack ("
+        "    md5sum TEXT PRIMARY KEY NOT NULL,"
+        "    offset INTEGER NOT NULL,"
+        "    size INTEGER NOT NULL) WITHOUT ROWID", None, con)
+    generation = tombll_common.picture_pack_generation(con)
+    pictures = tombll_common.query_return_everything(
+        "SELECT PictureID, md5sum FROM Picture WHERE length(data) > 0", None, con)
+    for picture_id, md5sum in pictures:
+        data = tombll_common.query_return_everything(
+            "SELECT data FROM Picture WHERE PictureID = ?", (picture_id, ), con)[0][0]
+        tombll_common.picture_pack_append(md5sum, data, con)
+        tombll_common.query_run(
+            "UPDATE Picture SET data = ? WHERE PictureID = ?", (b'', picture_id), con)
+    con.commit()
+    con.execute("VACUUM")
+    con.close()
+
+    print(f"Packed {len(pictures)} pictures")
+    print(f"Database size {size_before / 1048576:.1f} MiB -> "
+          f"{os.path.getsize(path) / 1048576:.1f} MiB, pack size "
+          f"{os.path.getsize(tombll_common.picture_pack_path(generation)) / 1048576:.1f} MiB")
+
+
+def compact_pictures():
+    """Rewrite the picture pack with only the pictures still in the Picture table.
+
+    Deleted levels and interrupted writes leave unreferenced bytes in the
+    append-only pack. The live pictures are copied in offset order to a pack
+    of the next generation. The new offsets and the generation are committed
+    together, only then is the old pack deleted. A crash before the commit
+    leaves the database on the old pack, one after it leaves a stray old
+    pack. Run it with the launcher closed, it keeps the old pack mapped.
+    """
+    con = database_make_connection()
+
+    database_begin_write(con)
+    generation = tombll_common.picture_pack_generation(con)
+    pack_path = tombll_common.picture_pack_path(generation)
+    new_path = tombll_common.picture_pack_path(generation + 1)
+    size_before = os.path.getsize(pack_path)
+    tombll_common.query_run(
+        "CREATE TABLE IF NOT EXISTS PicturePackFile ("
+        "    generation INTEGER NOT NULL)", None, con)
+    tombll_common.query_run(
+        "DELETE FROM PicturePack WHERE md5sum NOT IN (SELECT md5sum FROM Picture)",
+        None, con)
+    entries = tombll_common.query_return_everything(
+        "SELECT md5sum, offset, size FROM PicturePack ORDER BY offset", None, con)
+
+    with open(pack_path, mode='rb') as old_pack, \
+            open(new_path, mode='wb') as new_pack:
+        new_pack.write(tombll_common.picture_pack_header(generation + 1))
+        for md5sum, offset, size in entries:
+            old_pack.seek(offset)
+            data = old_pack.read(size)
+            tombll_common.query_run(
+                "UPDATE PicturePack SET offset = ? WHERE md5sum = ?",
+                (new_pack.tell(), md5sum), con)
+            new_pack.write(data)
+        new_pack.flush()
+        os.fsync(new_pack.fileno())
+
+    tombll_common.query_run("DELETE FROM PicturePackFile", None, con)
+    tombll_common.query_run(
+        "INSERT INTO PicturePackFile (generation) VALUES (?)", (generation + 1, ), con)
+    database_commit_and_close(con)
+    os.remove(pack_path)
+
+    print(f"Kept {len(entries)} pictures, pack size {size_before / 1048576:.1f} MiB -> "
+          f"{os.path.getsize(new_path) / 1048576:.1f} MiB")
+
+
+def verify_pictures():
+    """Check every picture in the pack against its Picture.md5sum.
+
+    Also reports pictures that are neither in the database nor in the pack,
+    and pack entries no Picture uses. Exits with 1 if a picture is damaged
+    or missing, or if the pack is not the generation the database points to.
+    """
+    con = database_make_connection()
+    generation = tombll_common.picture_pack_generation(con)
+    entries = tombll_common.query_return_everything(
+        "SELECT PicturePack.md5sum, PicturePack.offset, PicturePack.size, "
+        "Picture.PictureID "
+        "FROM PicturePack "
+        "LEFT JOIN Picture ON Picture.md5sum = PicturePack.md5sum "
+        "ORDER BY PicturePack.offset", None, con)
+    missing = tombll_common.query_return_everything(
+        "SELECT PictureID, md5sum FROM Picture "
+        "WHERE length(data) = 0 "
+        "AND md5sum NOT IN (SELECT md5sum FROM PicturePack)", None, con)
+    con.close()
+
+    damaged = 0
+    unused = 0
+    header = tombll_common.picture_pack_header(generation)
+    with open(tombll_common.picture_pack_path(generation), mode='rb') as pack:
+        if pack.read(len(header)) != header:
+            logging.error("Picture pack is not generation %s, "
+                          "the one the database points to", generation)
+            sys.exit(1)
+        for md5sum, offset, size, picture_id in entries:
+            pack.seek(offset)
+            data = pack.read(size)
+            if len(data) != size or \
+                    scrape_trle.scrape_common.calculate_data_md5(data) != md5sum:
+                logging.error("Damaged picture %s at offset %s", md5sum, offset)
+                damaged += 1
+            elif picture_id is None:
+                unused += 1
+
+    for picture_id, md5sum in missing:
+        logging.error("Picture %s %s has no data", picture_id, md5sum)
+
+    print(f"{len(entries)} pictures checked, {damaged} damaged, "
+          f"{len(missing)} missing, {unused} unused")
+    if damaged or missing:
+        sys.exit(1)
+
+
 def sync_cards():
     """Lazy tail sync of cards."""
     tailsync = TailSync()
@@ -700,6 +905,18 @@ if __name__ == "__main__":
     elif (sys.argv[1] == "-sc" and number_of_argument == 2):
         sync_cards()
 
+    elif (sys.argv[1] == "-z" and number_of_argument == 2):
+        compress_level_text()
+
+    elif (sys.argv[1] == "-pk" and number_of_argument == 2):
+        pack_pictures()
+
+    elif (sys.argv[1] == "-pc" and number_of_argument == 2):
+        compact_pictures()
+
+    elif (sys.argv[1] == "-pv" and number_of_argument == 2):
+        verify_pictures()
+
     elif (sys.argv[1] == "-ld" and number_of_argument == 3):
         list_downloads(sys.argv[2])
 
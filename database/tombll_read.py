@@ -328,11 +328,15 @@ def trle_cover_picture(trle_id, con):
     """Get TRLE cover picture."""
     query = '''
         SELECT
-            Picture.data
+            Picture.data,
+            Picture.md5sum
         FROM Info
         INNER JOIN Level ON (Info.InfoID = Level.infoID)
         INNER JOIN Screens ON (Level.LevelID = Screens.levelID)
         INNER JOIN Picture ON (Screens.pictureID = Picture.PictureID)
         WHERE Info.trleID = ? AND Screens.position = 0
     '''
-    return tombll_common.query_return_everything(query, (trle_id, ), con)[0][0]
+    data, md5sum = tombll_common.query_return_everything(query, (trle_id, ), con)[0]
+    if not data and tombll_common.picture_pack_enabled(con):
+        return tombll_common.picture_pack_read(md5sum, con)
+    return data
@@ -31,13 +31,14 @@ def database_level(data, level_id, con):
 
     # Prepare arguments for the update
     arg = (
-        data.get('body'),
-        data.get('walkthrough'),
+        tombll_common.compress_level_text(data.get('body'), con),
+        tombll_common.compress_level_text(data.get('walkthrough'), con),
         level_id
     )
 
     # Run the update query
     tombll_common.query_run(query, arg, con)
+    tombll_common.index_level_text(level_id, data.get('body'), data.get('walkthrough'), con)
 
     # Retrieve the associated infoID
     query = "SELECT infoID FROM Level WHERE LevelID = ?"
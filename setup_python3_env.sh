@@ -4,5 +4,5 @@ rm -fr .env
 python3 -m venv .env
 source .env/bin/activate
 pip install pycurl types-pycurl tqdm types-tqdm cryptography types-cryptography \
-    beautifulsoup4 types-beautifulsoup4 pillow types-pillow evdev \
+    beautifulsoup4 types-beautifulsoup4 pillow types-pillow zstandard evdev \
     debugpy mypy pylint bandit ruff pydocstyle flake8
@@ -14,6 +14,7 @@
 #include "../src/CommandLineParser.hpp"
 #include <QCommandLineOption>
 #include <QDebug>
+#include "../src/QueryStats.hpp"
 
 CommandLineParser::CommandLineParser(const QString& type) : m_processStatus(0) {
     if (type == "APP") {
@@ -115,6 +116,19 @@ CommandLineParser::CommandLineParser(const QString& type) : m_processStatus(0) {
         sortByReleaseDateOption.setDescription("Sort the list by release date");
         m_parser.addOption(sortByReleaseDateOption);
 
+        // Query stats ---------
+        QCommandLineOption dumpQueryStatsOption("dumpQueryStats");
+        dumpQueryStatsOption.setDescription(
+            "Write database query latency stats as JSON on exit");
+        dumpQueryStatsOption.setValueName("file");
+        m_parser.addOption(dumpQueryStatsOption);
+
+        QCommandLineOption slowQueryMsOption("slowQueryMs");
+        slowQueryMsOption.setDescription(
+            "Log database queries slower than this, 0 is off");
+        slowQueryMsOption.setValueName("ms");
+        m_parser.addOption(slowQueryMsOption);
+
     } else if (type == "TEST") {
         m_parser.setApplicationDescription("Tomb Raider Linux Launcher Test Suite");
         m_parser.addHelpOption();
@@ -213,6 +227,23 @@ StartupSetting CommandLineParser::process(const QStringList& arguments) {
         }
     }
 
+    // --- Query stats ---
+    if (m_parser.isSet("dumpQueryStats") == true) {
+        settings.queryStatsPath = m_parser.value("dumpQueryStats");
+    }
+
+    if (m_parser.isSet("slowQueryMs") == true) {
+        bool ok = false;
+        const qint64 value = m_parser.value("slowQueryMs").toLongLong(&ok);
+        if ((ok == true) && (value >= 0)) {
+            QueryStats::getInstance().setSlowQueryMs(value);
+        } else {
+            qCritical().noquote() << "Invalid slowQueryMs value:"
+                                  << m_parser.value("slowQueryMs");
+            m_processStatus = 1;
+        }
+    }
+
     // Collect all mutually exclusive sort options
     QStringList sortOptions = {
         "sortByReleaseDate",
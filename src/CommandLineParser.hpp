@@ -25,6 +25,7 @@ struct StartupSetting {
     bool installed = false;
     bool original = false;
     bool fullscreen = false;
+    QString queryStatsPath;  ///< Write the Data query stats here at exit
 };
 
 /**
@@ -12,9 +12,26 @@
  */
 
 #include "../src/Controller.hpp"
+#include <QDebug>
 #include <QMetaObject>
+#include "../src/Progress.hpp"
+#include "../src/TrashReaper.hpp"
+
+Controller::Controller() :
+        m_infoRequest(0),
+        m_infoId(0),
+        m_infoNext(0),
+        m_runningId(0),
+        m_detailCache(64 * 1024 * 1024) {
+    // Leave a core for the GUI thread
+    m_decodePool.setMaxThreadCount(
+        qMax(1, QThread::idealThreadCount() - 1));
+    m_readPool.setMaxThreadCount(2);
+    // Keep the reader threads, and their connections, around
+    m_readPool.setExpiryTimeout(-1);
+    m_prefetchPool.setMaxThreadCount(1);
+    m_prefetchPool.setExpiryTimeout(-1);
 
-Controller::Controller() {
     threadCovers.reset(new QThread());
     threadFile.reset(new QThread());
     threadScrape.reset(new QThread());
@@ -31,26 +48,18 @@ Controller::Controller() {
     threadFile->start();
     threadScrape->start();
 
-    connect(&model, &Model::modelTickSignal,
-            this,   &Controller::controllerTickSignal,
-        Qt::QueuedConnection);
-
-    connect(&fileManager, &FileManager::fileWorkTickSignal,
-            this,         &Controller::controllerTickSignal,
-        Qt::QueuedConnection);
-
     connect(&fileManager, &FileManager::fileWorkErrorSignal,
             this,        &Controller::controllerFileError,
         Qt::QueuedConnection);
 
-    connect(&downloader, &Downloader::networkWorkTickSignal,
-            this,        &Controller::controllerTickSignal,
-        Qt::QueuedConnection);
-
     connect(&downloader, &Downloader::networkWorkErrorSignal,
             this,        &Controller::controllerDownloadError,
         Qt::QueuedConnection);
 
+    connect(&TrashReaper::getInstance(), &TrashReaper::spaceFreedSignal,
+            this,   &Controller::controllerSpaceFreed,
+        Qt::QueuedConnection);
+
     connect(&model, &Model::generateListSignal,
             this,   &Controller::controllerGenerateList,
         Qt::QueuedConnection);
@@ -59,16 +68,34 @@ Controller::Controller() {
             this,   &Controller::controllerReloadLevelList,
         Qt::QueuedConnection);
 
+    connect(&model, &Model::modelListPageSignal,
+            this,   &Controller::controllerListPage,
+        Qt::QueuedConnection);
+
     connect(&model, &Model::modelLoadingDoneSignal,
             this,   &Controller::controllerLoadingDone,
         Qt::QueuedConnection);
 
     connect(&model, &Model::modelRunningDoneSignal,
-            this,   &Controller::controllerRunningDone,
+            this,   [this]() {
+            // Keep what was saved in the game that just ended
+            const int id = m_runningId;
+            runOnThreadFile([=]() { (void)model.backupSaveFiles(id); });
+            emit controllerRunningDone();
+        },
         Qt::QueuedConnection);
 }
 
 Controller::~Controller() {
+    m_decodePool.clear();
+    m_decodePool.waitForDone();
+    m_readPool.waitForDone();
+    m_prefetchPool.clear();
+    m_prefetchPool.waitForDone();
+    qDebug() << "LevelDetailCache: hit" << m_detailCache.hits() << "of"
+             << (m_detailCache.hits() + m_detailCache.misses())
+             << "level opens";
+
     threadCovers->quit();
     threadFile->quit();
     threadScrape->quit();
@@ -100,14 +127,19 @@ void Controller::setup() {
 }
 
 void Controller::setupGame(int id) {
+    // Before the work is queued, the GUI must not sample the last install
+    Progress::getInstance().reset();
     runOnThreadFile([=]() { model.setupGame(id); });
 }
 
 void Controller::setupLevel(int id) {
+    Progress::getInstance().reset();
     runOnThreadFile([=]() { model.getLevel(id); });
 }
 
 void Controller::updateLevel(int id) {
+    // The scraper writes new Info data for this level
+    m_detailCache.remove(id);
     runOnThreadScrape([=]() { model.updateLevel(id); });
 }
 
@@ -119,29 +151,149 @@ void Controller::getCoverList(QVector<QSharedPointer<ListItemData>> items) {
     runOnThreadCovers([=]() { model.getCoverList(items); });
 }
 
-// UI/main thread work
-void Controller::run(RunnerOptions opptions) {
-    model.run(opptions);
+void Controller::getInfoImages(qint64 id, const QVector<QByteArray>& images,
+                               const QSize& size) {
+    // A new request makes the results of the last one stale
+    m_infoRequest++;
+    m_infoId = id;
+    m_infoNext = 0;
+    m_infoPending.clear();
+    m_infoScreens.clear();
+    m_decodePool.clear();
+
+    const quint64 request = m_infoRequest;
+    for (qint64 i = 0; i < images.size(); i++) {
+        const QByteArray image = images.at(i);
+        m_decodePool.start([this, request, i, image, size]() {
+            QImage decoded = InfoData::decodeImage(image, size);
+            QMetaObject::invokeMethod(this, [=]() {
+                infoImageDecoded(request, i, decoded);
+            }, Qt::QueuedConnection);
+        });
+    }
 }
 
-int Controller::checkGameDirectory(int id) {
-    return model.checkGameDirectory(id);
+void Controller::infoImageDecoded(
+        quint64 request, qint64 index, QImage image) {
+    if (request == m_infoRequest) {
+        m_infoPending.insert(index, image);
+        while (m_infoPending.contains(m_infoNext)) {
+            m_infoScreens.append(m_infoPending.take(m_infoNext));
+            emit controllerInfoImage(m_infoId, m_infoScreens.last());
+            m_infoNext++;
+        }
+        // Keep the whole gallery for the next visit
+        m_detailCache.setScreens(m_infoId, m_infoScreens);
+    }
+}
+
+void Controller::getList() {
+    getListPage(Data::m_listFirstRelease, Data::m_listFirstId);
+}
+
+void Controller::getListPage(const QString& release, qint64 trleId) {
+    // One page per task, the covers asked for by the pages already shown
+    // are queued in between the pages still to read
+    runOnThreadCovers([=]() {
+        QString nextRelease = release;
+        qint64 nextId = trleId;
+        if (!model.getListPage(&nextRelease, &nextId)) {
+            getListPage(nextRelease, nextId);
+        }
+    });
 }
 
-void Controller::getList(QVector<QSharedPointer<ListItemData>>* list) {
-    model.getList(list);
+// Database reads on the reader pool
+LevelDetail Controller::loadLevelDetail(qint64 id) {
+    LevelDetail detail;
+    if (!m_detailCache.lookup(id, &detail)) {
+        detail.info = model.getInfo(id);
+        detail.walkthrough = model.getWalkthrough(id);
+        // Not scraped yet levels are fetched by updateLevel()
+        if (!(detail.info.m_body == "" &&
+                    detail.info.m_imageData.size() == 0)) {
+            m_detailCache.insert(id, detail);
+        }
+    }
+    return detail;
 }
 
-const InfoData Controller::getInfo(int id) {
-    return model.getInfo(id);
+QFuture<LevelDetail> Controller::getLevelDetail(int id) {
+    return runOnReadPool<LevelDetail>([=]() { return loadLevelDetail(id); });
 }
 
-const bool Controller::checkZip(int id) {
-    return model.checkZip(id);
+void Controller::prefetchLevels(const QList<qint64>& ids, const QSize& size) {
+    // Drop the prefetch for the last selection, it is not wanted anymore
+    const quint64 request = ++m_prefetchRequest;
+    m_prefetchPool.clear();
+    for (const qint64 id : ids) {
+        m_prefetchPool.start([this, request, id, size]() {
+            if (request != m_prefetchRequest) {
+                return;
+            }
+            LevelDetail detail;
+            if (!m_detailCache.peek(id, &detail)) {
+                detail.info = model.getInfo(id);
+                detail.walkthrough = model.getWalkthrough(id);
+                if (detail.info.m_body == "" &&
+                        detail.info.m_imageData.size() == 0) {
+                    return;
+                }
+                m_detailCache.insert(id, detail);
+            }
+            if (!detail.hasScreens()) {
+                QVector<QImage> screens;
+                for (const QByteArray& image : detail.info.m_imageData) {
+                    if (request != m_prefetchRequest) {
+                        return;
+                    }
+                    screens.append(InfoData::decodeImage(image, size));
+                }
+                m_detailCache.setScreens(id, screens);
+            }
+        });
+    }
 }
 
-const bool Controller::deleteZip(int id) {
-    return model.deleteZip(id);
+QFuture<bool> Controller::checkZip(int id) {
+    return runOnReadPool<bool>([=]() { return model.checkZip(id); });
+}
+
+QFuture<QString> Controller::getWalkthrough(int id) {
+    return runOnReadPool<QString>([=]() {
+        return loadLevelDetail(id).walkthrough;
+    });
+}
+
+QFuture<QVector<qint64>> Controller::searchLevels(
+        const QString& text, int scope) {
+    return runOnReadPool<QVector<qint64>>([=]() {
+        return model.searchLevels(text, scope);
+    });
+}
+
+// UI/main thread work
+void Controller::run(RunnerOptions opptions) {
+    m_runningId = opptions.id;
+    // Snapshot the saves before the game can change them and look up the
+    // type, the runner itself is started back on this thread
+    runOnThreadFile([=]() {
+        (void)model.backupSaveFiles(opptions.id);
+        RunnerOptions options = opptions;
+        options.type = model.getType(options.id);
+        QMetaObject::invokeMethod(this,
+                [=]() { model.run(options); }, Qt::QueuedConnection);
+    });
+}
+
+int Controller::checkGameDirectory(int id) {
+    return model.checkGameDirectory(id);
+}
+
+
+
+QFuture<bool> Controller::deleteZip(int id) {
+    return runOnThreadFile<bool>([=]() { return model.deleteZip(id); });
 }
 
 void Controller::killRunner() {
@@ -152,12 +304,21 @@ const bool Controller::deleteLevel(int id) {
     return model.deleteLevel(id);
 }
 
-const QString Controller::getWalkthrough(int id) {
-    return model.getWalkthrough(id);
+QFuture<QVector<qint64>> Controller::getSaveSnapshots(int id) {
+    return runOnThreadFile<QVector<qint64>>([=]() {
+        return model.getSaveSnapshots(id);
+    });
+}
+
+QFuture<bool> Controller::restoreSaveSnapshot(int id, qint64 snapshot) {
+    return runOnThreadFile<bool>([=]() {
+        return model.restoreSaveSnapshot(id, snapshot);
+    });
 }
 
-bool Controller::link(int id) {
-    return model.setLink(id);
+
+QFuture<bool> Controller::link(int id) {
+    return runOnThreadFile<bool>([=]() { return model.setLink(id); });
 }
 
 int Controller::getItemState(int id) {
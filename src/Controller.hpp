@@ -13,9 +13,16 @@
 
 #ifndef SRC_CONTROLLER_HPP_
 #define SRC_CONTROLLER_HPP_
+#include <QFuture>
+#include <QImage>
+#include <QMap>
 #include <QObject>
+#include <QPromise>
+#include <QSharedPointer>
 #include <QThread>
+#include <QThreadPool>
 #include "../src/globalTypes.hpp"
+#include "../src/LevelDetailCache.hpp"
 #include "../src/Model.hpp"
 
 /**
@@ -42,24 +49,33 @@ class Controller : public QObject {
 
     void killRunner();
     int checkGameDirectory(int id);
-    void getList(QVector<QSharedPointer<ListItemData>>* list);
-    const InfoData getInfo(int id);
-    const bool checkZip(int id);
-    const bool deleteZip(int id);
+    void getList();
+    QFuture<LevelDetail> getLevelDetail(int id);
+    void prefetchLevels(const QList<qint64>& ids, const QSize& size);
+    void getInfoImages(qint64 id, const QVector<QByteArray>& images,
+                       const QSize& size);
+    QFuture<bool> checkZip(int id);
+    QFuture<bool> deleteZip(int id);
     const bool deleteLevel(int id);
-    const QString getWalkthrough(int id);
-    bool link(int id);
+    QFuture<QVector<qint64>> getSaveSnapshots(int id);
+    QFuture<bool> restoreSaveSnapshot(int id, qint64 snapshot);
+    QFuture<QString> getWalkthrough(int id);
+    QFuture<QVector<qint64>> searchLevels(const QString& text, int scope);
+    QFuture<bool> link(int id);
     int getItemState(int id);
     void clearRunner();
 
  signals:
     void controllerGenerateList(const QList<int>& availableGames);
-    void controllerTickSignal();
     void controllerDownloadError(int status);
     void controllerFileError(int status);
     void controllerReloadLevelList();
+    void controllerInfoImage(qint64 id, QImage image);
+    void controllerListPage(
+        QVector<QSharedPointer<ListItemData>> page, bool last);
     void controllerLoadingDone();
     void controllerRunningDone();
+    void controllerSpaceFreed(quint64 bytes);
 
  private:
     Controller();
@@ -69,6 +85,44 @@ class Controller : public QObject {
     void runOnThreadCovers(std::function<void()> func);
     void runOnThreadFile(std::function<void()> func);
     void runOnThreadScrape(std::function<void()> func);
+    void getListPage(const QString& release, qint64 trleId);
+    void infoImageDecoded(quint64 request, qint64 index, QImage image);
+    LevelDetail loadLevelDetail(qint64 id);
+
+    /**
+     * @brief Run file work on the file thread and hand back its result.
+     *
+     * Queued after any snapshot of the saves already on that thread.
+     */
+    template <typename T>
+    QFuture<T> runOnThreadFile(std::function<T()> func) {
+        auto promise = QSharedPointer<QPromise<T>>::create();
+        QFuture<T> future = promise->future();
+        promise->start();
+        runOnThreadFile([promise, func]() {
+            promise->addResult(func());
+            promise->finish();
+        });
+        return future;
+    }
+
+    /**
+     * @brief Run a database read on the reader pool.
+     *
+     * Each pool thread has its own read-only connection, the GUI thread
+     * gets the result through the future, usually with then(this, ...).
+     */
+    template <typename T>
+    QFuture<T> runOnReadPool(std::function<T()> func) {
+        auto promise = QSharedPointer<QPromise<T>>::create();
+        QFuture<T> future = promise->future();
+        promise->start();
+        m_readPool.start([promise, func]() {
+            promise->addResult(func());
+            promise->finish();
+        });
+        return future;
+    }
 
     QScopedPointer<QThread> threadCovers;
     QScopedPointer<QThread> threadFile;
@@ -78,6 +132,25 @@ class Controller : public QObject {
     QScopedPointer<QObject> workerFile;
     QScopedPointer<QObject> workerScrape;
 
+    // Small pool of SQLite readers for the async API
+    QThreadPool m_readPool;
+
+    // Info screenshots decoded in parallel and handed out in order
+    QThreadPool m_decodePool;
+    quint64 m_infoRequest;
+    qint64 m_infoId;
+    qint64 m_infoNext;
+    QMap<qint64, QImage> m_infoPending;
+    QVector<QImage> m_infoScreens;
+
+    // Level whose saves are snapshot when the game exits
+    int m_runningId;
+
+    // Info and walkthrough of the selected level and its neighbours
+    LevelDetailCache m_detailCache;
+    QThreadPool m_prefetchPool;
+    std::atomic<quint64> m_prefetchRequest{0};
+
     Data& data = Data::getInstance();
     FileManager& fileManager = FileManager::getInstance();
     Model& model = Model::getInstance();
@@ -0,0 +1,125 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "../src/CopyEngine.hpp"
+#include <QByteArray>
+#include <QDebug>
+#include <QFile>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+bool CopyEngine::reflink(int fromFd, int toFd) {
+    return ioctl(toFd, FICLONE, fromFd) == 0;
+}
+
+int CopyEngine::copyRange(int fromFd, int toFd, qint64 size) {
+    // 0: copied, 1: not supported here and nothing copied, 2: error
+    qint64 copied = 0;
+    while (copied < size) {
+        const ssize_t n = copy_file_range(
+            fromFd, nullptr, toFd, nullptr,
+            static_cast<size_t>(size - copied), 0);
+        if (n > 0) {
+            copied += n;
+        } else if ((n < 0) && (errno == EINTR)) {
+            continue;
+        } else if ((copied == 0) && (n < 0) &&
+                ((errno == EXDEV) || (errno == EINVAL) ||
+                 (errno == ENOSYS) || (errno == EOPNOTSUPP))) {
+            return 1;
+        } else {
+            // Zero means the source shrank under us
+            return 2;
+        }
+    }
+    return 0;
+}
+
+bool CopyEngine::copyBuffer(int fromFd, int toFd) {
+    QByteArray buffer(1 << 20, Qt::Uninitialized);
+    while (true) {
+        const ssize_t n = read(fromFd, buffer.data(), buffer.size());
+        if (n == 0) {
+            return true;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        ssize_t written = 0;
+        while (written < n) {
+            const ssize_t w =
+                write(toFd, buffer.constData() + written, n - written);
+            if (w < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            written += w;
+        }
+    }
+}
+
+CopyEngine::Strategy CopyEngine::copy(const QString& from, const QString& to) {
+    QFile source(from);
+    if (!source.open(QIODevice::ReadOnly)) {  // flawfinder: ignore
+        qWarning() << "CopyEngine: Could not read" << from
+                   << source.errorString();
+        return Strategy::Failed;
+    }
+    QFile target(to);
+    if (!target.open(QIODevice::WriteOnly | QIODevice::NewOnly)) {
+        qWarning() << "CopyEngine: Could not create" << to
+                   << target.errorString();
+        return Strategy::Failed;
+    }
+
+    const int fromFd = source.handle();
+    const int toFd = target.handle();
+    Strategy strategy = Strategy::Failed;
+    if (reflink(fromFd, toFd) == true) {
+        strategy = Strategy::Reflink;
+    } else {
+        const int range = copyRange(fromFd, toFd, source.size());
+        if (range == 0) {
+            strategy = Strategy::CopyRange;
+        } else if ((range == 1) && (copyBuffer(fromFd, toFd) == true)) {
+            strategy = Strategy::Buffer;
+        }
+    }
+
+    if (strategy != Strategy::Failed) {
+        (void)target.setPermissions(source.permissions());
+    } else {
+        qWarning() << "CopyEngine: Failed to copy" << from << "to" << to
+                   << strerror(errno);
+        target.close();
+        (void)target.remove();
+    }
+    return strategy;
+}
+
+const char* CopyEngine::strategyName(Strategy strategy) {
+    switch (strategy) {
+    case Strategy::Reflink:   return "reflink";
+    case Strategy::CopyRange: return "copy_file_range";
+    case Strategy::Buffer:    return "buffer";
+    default:                  return "failed";
+    }
+}
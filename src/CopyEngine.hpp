@@ -0,0 +1,59 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef SRC_COPYENGINE_HPP_
+#define SRC_COPYENGINE_HPP_
+
+#include <QString>
+
+/**
+ * @class CopyEngine
+ * @brief File copies that let the kernel do the work.
+ *
+ * A copy first tries a FICLONE reflink, which shares the blocks on
+ * copy-on-write filesystems like btrfs and XFS, so it is instant and uses
+ * no space. Next is copy_file_range, which copies inside the kernel and
+ * lets NFS and SMB copy on the server. Last is a read/write loop with a
+ * large buffer.
+ */
+class CopyEngine {
+ public:
+    enum class Strategy { Failed, Reflink, CopyRange, Buffer };
+
+    /**
+     * @brief Copy a file with the fastest strategy that works.
+     *
+     * The destination gets the permissions of the source.
+     *
+     * @param from Source file.
+     * @param to Destination file, must not exist.
+     * @return The strategy that copied the file, Strategy::Failed on error.
+     */
+    static Strategy copy(const QString& from, const QString& to);
+
+    /**
+     * @brief Share the blocks of one open file with another.
+     * @param fromFd Source file descriptor, opened for reading.
+     * @param toFd Destination file descriptor, opened for writing.
+     * @return `true` if the destination is now a reflink of the source.
+     */
+    static bool reflink(int fromFd, int toFd);
+
+    static const char* strategyName(Strategy strategy);
+
+ private:
+    static int copyRange(int fromFd, int toFd, qint64 size);
+    static bool copyBuffer(int fromFd, int toFd);
+};
+
+#endif  // SRC_COPYENGINE_HPP_
@@ -0,0 +1,217 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "../src/CoverAtlas.hpp"
+#include <QDebug>
+#include <QMutexLocker>
+#include <QPainter>
+#include <cstring>
+
+CoverAtlas::CoverAtlas() :
+        m_map(nullptr),
+        m_mapSize(0) {
+}
+
+CoverAtlas::~CoverAtlas() {
+    close();
+}
+
+QByteArray CoverAtlas::makeHeader() {
+    const quint32 fields[4] = {
+        m_version,
+        static_cast<quint32>(m_tileWidth),
+        static_cast<quint32>(m_tileHeight),
+        static_cast<quint32>(QImage::Format_ARGB32_Premultiplied)
+    };
+    QByteArray header("TRLLATLS");
+    header.append(reinterpret_cast<const char*>(fields), sizeof(fields));
+    header.append(m_headerSize - header.size(), '\0');
+    return header;
+}
+
+bool CoverAtlas::open(const QString& filePath) {
+    QMutexLocker locker(&m_mutex);
+    unmap();
+    m_file.close();
+    m_index.clear();
+
+    m_file.setFileName(filePath);
+    bool status = m_file.open(QIODevice::ReadWrite);  // flawfinder: ignore
+    if (!status) {
+        qWarning() << "CoverAtlas: Could not open" << filePath
+                   << m_file.errorString();
+    }
+
+    if (status == true) {
+        const QByteArray header = makeHeader();
+        if (m_file.read(m_headerSize) != header) {
+            qDebug() << "CoverAtlas: New or outdated atlas, rebuilding"
+                     << filePath;
+            status = m_file.resize(0) &&
+                (m_file.write(header) == m_headerSize);
+        }
+    }
+
+    if (status == true) {
+        // Drop a half written record at the end
+        const qint64 records = (m_file.size() - m_headerSize) / m_recordSize;
+        status = m_file.resize(m_headerSize + (records * m_recordSize));
+    }
+
+    if (status == true) {
+        status = remap();
+    }
+
+    if (status == true) {
+        for (qint64 offset = m_headerSize;
+                (offset + m_recordSize) <= m_mapSize;
+                offset += m_recordSize) {
+            qint64 trleId = 0;
+            (void)memcpy(&trleId, m_map + offset, sizeof(trleId));
+            m_index.insert(trleId, offset);
+        }
+        qDebug() << "CoverAtlas:" << m_index.size() << "covers in" << filePath;
+    } else {
+        m_file.close();
+    }
+    return status;
+}
+
+void CoverAtlas::close() {
+    QMutexLocker locker(&m_mutex);
+    unmap();
+    m_file.close();
+    m_index.clear();
+}
+
+bool CoverAtlas::remap() {
+    unmap();
+    m_mapSize = m_file.size();
+    m_map = m_file.map(0, m_mapSize);
+    if (m_map == nullptr) {
+        qWarning() << "CoverAtlas: Could not map" << m_file.fileName()
+                   << m_file.errorString();
+        m_mapSize = 0;
+    }
+    return m_map != nullptr;
+}
+
+void CoverAtlas::unmap() {
+    if (m_map != nullptr) {
+        (void)m_file.unmap(m_map);
+        m_map = nullptr;
+        m_mapSize = 0;
+    }
+}
+
+bool CoverAtlas::lookup(qint64 trleId, const QString& md5sum, QImage* tile) {
+    QMutexLocker locker(&m_mutex);
+    bool status = false;
+
+    const auto it = m_index.constFind(trleId);
+    if (it != m_index.constEnd()) {
+        const qint64 offset = it.value();
+        // Records appended since the last lookup are not mapped yet
+        if ((offset + m_recordSize) > m_mapSize) {
+            (void)remap();
+        }
+        const QByteArray md5 = md5sum.toLatin1();
+        if ((m_map != nullptr) &&
+                ((offset + m_recordSize) <= m_mapSize) &&
+                (md5.size() == m_md5Size)) {
+            const uchar* record = m_map + offset;
+            if (memcmp(record + 8, md5.constData(), m_md5Size) == 0) {
+                const QImage mapped(
+                    record + m_recordHeaderSize,
+                    m_tileWidth,
+                    m_tileHeight,
+                    m_tileWidth * 4,
+                    QImage::Format_ARGB32_Premultiplied);
+                // Detach from the mapping before it can be remapped
+                *tile = mapped.copy();
+                status = true;
+            }
+        }
+    }
+    return status;
+}
+
+bool CoverAtlas::store(
+        qint64 trleId, const QString& md5sum, const QImage& tile) {
+    QMutexLocker locker(&m_mutex);
+    const QByteArray md5 = md5sum.toLatin1();
+    const QImage image =
+        tile.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    bool status = m_file.isOpen();
+
+    if ((md5.size() != m_md5Size) ||
+            (image.width() != m_tileWidth) ||
+            (image.height() != m_tileHeight)) {
+        qDebug() << "CoverAtlas: Refusing bad tile for lid" << trleId;
+        status = false;
+    }
+
+    if (status == true) {
+        QByteArray record;
+        record.reserve(m_recordSize);
+        record.append(reinterpret_cast<const char*>(&trleId), sizeof(trleId));
+        record.append(md5);
+        for (qint64 y = 0; y < m_tileHeight; y++) {
+            record.append(
+                reinterpret_cast<const char*>(image.constScanLine(y)),
+                m_tileWidth * 4);
+        }
+
+        // Overwrite the old record if the picture changed
+        const auto it = m_index.constFind(trleId);
+        const qint64 offset =
+            (it != m_index.constEnd()) ? it.value() : m_file.size();
+        status = m_file.seek(offset) &&
+            (m_file.write(record) == m_recordSize) &&
+            m_file.flush();
+        if (status == true) {
+            m_index.insert(trleId, offset);
+        } else {
+            qWarning() << "CoverAtlas: Failed to write cover for lid" << trleId;
+        }
+    }
+    return status;
+}
+
+QImage CoverAtlas::makeTile(const QByteArray& imageData) {
+    const QSize targetSize(m_tileWidth, m_tileHeight);
+    QImage tile(targetSize, QImage::Format_ARGB32_Premultiplied);
+    // Ensure a transparent background
+    tile.fill(Qt::transparent);
+
+    QImage image;
+    if (!image.loadFromData(imageData, "WEBP")) {
+        qDebug() << "Could not load webp data to QImage.";
+    } else {
+        const QImage scaled = image.scaled(
+            targetSize,
+            Qt::KeepAspectRatio,
+            Qt::SmoothTransformation);
+
+        // Calculate offsets for centering the scaled image
+        const qint64 xOffset = (targetSize.width() - scaled.width()) / 2;
+        const qint64 yOffset = (targetSize.height() - scaled.height()) / 2;
+
+        QPainter painter(&tile);
+        painter.setRenderHint(QPainter::Antialiasing, true);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+        painter.drawImage(xOffset, yOffset, scaled);
+        painter.end();
+    }
+    return tile;
+}
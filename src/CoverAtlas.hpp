@@ -0,0 +1,107 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef SRC_COVERATLAS_HPP_
+#define SRC_COVERATLAS_HPP_
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+
+/**
+ * @class CoverAtlas
+ * @brief On-disk cache of pre-scaled level card covers.
+ *
+ * The atlas is a memory-mapped file of fixed size records, one per trle.net
+ * lid. Each record holds the md5sum of the source Picture and a ready to blit
+ * 160x120 ARGB32 premultiplied tile. A record is only used when its md5sum
+ * matches the Picture in the database, a changed picture is re-rendered and
+ * written over the old record.
+ *
+ * File layout:
+ * - Header: magic, version, tile width, tile height, image format.
+ * - Records: trleID (8 bytes), md5sum (32 bytes hex), tile pixels.
+ */
+class CoverAtlas {
+ public:
+    CoverAtlas();
+    ~CoverAtlas();
+
+    /**
+     * @brief Open or create the atlas file and index the records.
+     *
+     * An atlas with a header from another version or tile size is truncated.
+     *
+     * @param filePath Full path to the atlas file.
+     * @return `true` if the atlas can be used.
+     */
+    bool open(const QString& filePath);
+
+    /**
+     * @brief Unmap and close the atlas file.
+     */
+    void close();
+
+    /**
+     * @brief Copy a tile out of the mapped atlas, no image decoding is done.
+     * @param trleId trle.net lid.
+     * @param md5sum Checksum of the source Picture in the database.
+     * @param tile Receives the tile on a hit.
+     * @return `true` if there was a record with a matching md5sum.
+     */
+    bool lookup(qint64 trleId, const QString& md5sum, QImage* tile);
+
+    /**
+     * @brief Write or overwrite the tile record for a level.
+     * @param trleId trle.net lid.
+     * @param md5sum Checksum of the source Picture in the database.
+     * @param tile Tile made by makeTile().
+     * @return `true` if the record was written.
+     */
+    bool store(qint64 trleId, const QString& md5sum, const QImage& tile);
+
+    /**
+     * @brief Decode a WEBP cover and center it on a transparent tile.
+     * @param imageData WEBP picture data.
+     * @return A tileWidth x tileHeight ARGB32 premultiplied image.
+     */
+    static QImage makeTile(const QByteArray& imageData);
+
+    static constexpr qint64 m_tileWidth = 160;
+    static constexpr qint64 m_tileHeight = 120;
+
+ private:
+    static QByteArray makeHeader();
+    bool remap();
+    void unmap();
+
+    static constexpr quint32 m_version = 1;
+    static constexpr qint64 m_headerSize = 32;
+    static constexpr qint64 m_md5Size = 32;
+    static constexpr qint64 m_recordHeaderSize = 8 + m_md5Size;
+    static constexpr qint64 m_tileSize = m_tileWidth * m_tileHeight * 4;
+    static constexpr qint64 m_recordSize = m_recordHeaderSize + m_tileSize;
+
+    QFile m_file;
+    uchar* m_map;
+    qint64 m_mapSize;
+    QHash<qint64, qint64> m_index;  ///< trleID to record offset
+    QMutex m_mutex;
+
+    Q_DISABLE_COPY(CoverAtlas)
+};
+
+#endif  // SRC_COVERATLAS_HPP_
@@ -12,292 +12,1152 @@
  */
 
 #include "../src/Data.hpp"
+#include "../src/QueryStats.hpp"
+#include <QRegularExpression>
+#include <QVersionNumber>
+#include <QtEndian>
+#include <iterator>
+#include <memory>
+
+namespace {
+// SQL text for the prepared statement cache, indexed by Data::Statement
+const char* const statementSql[] = {
+    // ListRowCount
+    "SELECT COUNT(*) FROM Level",
+
+    // ListItems, one keyset page after (:release, :id) newest first
+    "SELECT Info.trleID, "
+    "Info.title, ("
+    "    SELECT GROUP_CONCAT(Author.value, ', ') "
+    "    FROM AuthorList "
+    "    JOIN Author ON AuthorList.authorID = Author.AuthorID "
+    "    WHERE AuthorList.levelID = Level.LevelID) AS authors, "
+    "Info.type, "
+    "Info.class, "
+    "Info.release, "
+    "Info.difficulty, "
+    "Info.duration "
+    "FROM Info "
+    "JOIN Level ON Level.infoID = Info.InfoID "
+    "WHERE (Info.release, Info.trleID) < (:release, :id) "
+    "ORDER BY Info.release DESC, Info.trleID DESC "
+    "LIMIT :limit",
+
+    // CoverMd5Batch
+    "SELECT Info.trleID, Picture.md5sum "
+    "FROM Info "
+    "JOIN Level ON Level.infoID = Info.InfoID "
+    "JOIN Screens ON Level.LevelID = Screens.levelID "
+    "JOIN Picture ON Screens.pictureID = Picture.PictureID "
+    "WHERE Screens.position = 0 AND Info.trleID IN (%1)",
+
+    // CoverDataBatch
+    "SELECT Info.trleID, Picture.data, PicturePack.offset, PicturePack.size "
+    "FROM Info "
+    "JOIN Level ON Level.infoID = Info.InfoID "
+    "JOIN Screens ON Level.LevelID = Screens.levelID "
+    "JOIN Picture ON Screens.pictureID = Picture.PictureID "
+    "LEFT JOIN PicturePack ON Picture.md5sum = PicturePack.md5sum "
+    "WHERE Screens.position = 0 AND Info.trleID IN (%1)",
+
+    // Info
+    "SELECT Level.body, Picture.data, PicturePack.offset, PicturePack.size "
+    "FROM Level "
+    "JOIN Info ON Level.infoID = Info.InfoID "
+    "LEFT JOIN Screens "
+    "    ON Level.LevelID = Screens.levelID "
+    "    AND Screens.position > 0 "
+    "LEFT JOIN Picture "
+    "    ON Screens.pictureID = Picture.PictureID "
+    "LEFT JOIN PicturePack "
+    "    ON Picture.md5sum = PicturePack.md5sum "
+    "WHERE Info.trleID = :id "
+    "ORDER BY Screens.position ASC",
+
+    // Walkthrough
+    "SELECT Level.walkthrough "
+    "FROM Level "
+    "JOIN Info ON Level.infoID = Info.InfoID "
+    "WHERE Info.trleID = :id",
+
+    // Type
+    "SELECT Info.type "
+    "FROM Info "
+    "WHERE Info.trleID = :id",
+
+    // Download
+    "SELECT Zip.*, Info.type "
+    "FROM Level "
+    "JOIN Info ON Level.infoID = Info.InfoID "
+    "JOIN ZipList ON Level.LevelID = ZipList.levelID "
+    "JOIN Zip ON ZipList.zipID = Zip.ZipID "
+    "WHERE Info.trleID = :id",
+
+    // SetDownloadMd5
+    "UPDATE Zip "
+    "SET md5sum = :newMd5sum "
+    "WHERE Zip.ZipID IN ("
+    "    SELECT ZipList.zipID"
+    "    FROM Level"
+    "    JOIN Info ON Level.infoID = Info.InfoID"
+    "    JOIN ZipList ON Level.LevelID = ZipList.levelID"
+    "    WHERE Info.trleID = :id)",
+
+    // FileList
+    "SELECT File.path, File.md5sum "
+    "FROM File "
+    "JOIN GameFileList ON File.FileID = GameFileList.fileID "
+    "WHERE GameFileList.gameID = :id",
+
+    // SearchLevels
+    "SELECT trleID "
+    "FROM LevelSearch "
+    "WHERE LevelSearch MATCH :match "
+    "ORDER BY rank",
+
+    // LevelTextDictionary
+    "SELECT data "
+    "FROM Dictionary "
+    "WHERE name = 'level_text'",
+
+    // FileHashLookup, hashes of a file unchanged since it was hashed
+    "SELECT md5sum, blake2b "
+    "FROM FileHash "
+    "WHERE device = :device AND inode = :inode "
+    "AND size = :size AND mtimeNs = :mtimeNs",
+
+    // FileHashStore
+    "INSERT OR REPLACE INTO FileHash "
+    "(device, inode, size, mtimeNs, md5sum, blake2b) "
+    "VALUES (:device, :inode, :size, :mtimeNs, :md5sum, :blake2b)",
+
+    // PicturePackGeneration
+    "SELECT generation "
+    "FROM PicturePackFile",
+};
+
+// Tuning of the read-only connections, the database is opened read-only
+// as well. Not `immutable`, tombll_manage_data.py may write while we run
+const QStringList readerPragmas = {
+    "PRAGMA mmap_size = 268435456",
+    "PRAGMA query_only = ON",
+    "PRAGMA temp_store = MEMORY",
+    "PRAGMA cache_size = -8192",
+};
+
+// Tuning of the writer connection
+const QStringList writerPragmas = {
+    "PRAGMA journal_mode = WAL",
+    "PRAGMA synchronous = NORMAL",
+    "PRAGMA mmap_size = 268435456",
+};
+
+// Upper bound for one decompressed Level.body or Level.walkthrough
+constexpr unsigned long long levelTextMaxSize = 16 * 1024 * 1024;
+
+// One zstd decompression context per thread, freed when the thread exits
+ZSTD_DCtx* getThreadDecompressContext() {
+    struct Free {
+        void operator()(ZSTD_DCtx* context) const {
+            ZSTD_freeDCtx(context);
+        }
+    };
+    thread_local std::unique_ptr<ZSTD_DCtx, Free> context(ZSTD_createDCtx());
+    return context.get();
+}
+
+// Rebuild the LevelSearch rows of the levels selected by a WHERE clause
+#define LEVEL_SEARCH_REFRESH(where) \
+    "DELETE FROM LevelSearch WHERE rowid IN (" \
+    "    SELECT Level.LevelID FROM Level " where "); " \
+    "INSERT INTO LevelSearch" \
+    "    (rowid, title, authors, body, walkthrough, trleID) " \
+    "SELECT Level.LevelID, Info.title, (" \
+    "    SELECT GROUP_CONCAT(Author.value, ', ') " \
+    "    FROM AuthorList " \
+    "    JOIN Author ON AuthorList.authorID = Author.AuthorID " \
+    "    WHERE AuthorList.levelID = Level.LevelID), " \
+    "Level.body, Level.walkthrough, Info.trleID " \
+    "FROM Level " \
+    "JOIN Info ON Level.infoID = Info.InfoID " where ";"
+
+// Same as LEVEL_SEARCH_REFRESH, but a compressed body or walkthrough can't
+// be indexed in SQL, so the text already in LevelSearch is kept for those
+#define LEVEL_SEARCH_UPSERT(where) \
+    "INSERT OR REPLACE INTO LevelSearch" \
+    "    (rowid, title, authors, body, walkthrough, trleID) " \
+    "SELECT Level.LevelID, Info.title, (" \
+    "    SELECT GROUP_CONCAT(Author.value, ', ') " \
+    "    FROM AuthorList " \
+    "    JOIN Author ON AuthorList.authorID = Author.AuthorID " \
+    "    WHERE AuthorList.levelID = Level.LevelID), " \
+    "CASE WHEN typeof(Level.body) = 'blob' THEN (" \
+    "    SELECT body FROM LevelSearch WHERE rowid = Level.LevelID) " \
+    "ELSE Level.body END, " \
+    "CASE WHEN typeof(Level.walkthrough) = 'blob' THEN (" \
+    "    SELECT walkthrough FROM LevelSearch WHERE rowid = Level.LevelID) " \
+    "ELSE Level.walkthrough END, " \
+    "Info.trleID " \
+    "FROM Level " \
+    "JOIN Info ON Level.infoID = Info.InfoID " where ";"
+
+/**
+ * @struct Migration
+ * @brief Schema upgrade to a version, applied in one transaction.
+ */
+struct Migration {
+    const char* version;
+    QStringList statements;
+};
+
+// Schema upgrades for the user's tombll.db, in version order
+const QVector<Migration> migrations = {
+    {"0.0.2", {
+        // Info.trleID and Screens(levelID, position) are already
+        // indexed by their UNIQUE constraints
+        "CREATE INDEX IF NOT EXISTS idx_Level_infoID "
+        "ON Level(infoID)",
+        "CREATE INDEX IF NOT EXISTS idx_AuthorList_levelID "
+        "ON AuthorList(levelID)",
+        "CREATE INDEX IF NOT EXISTS idx_ZipList_levelID "
+        "ON ZipList(levelID)",
+        "CREATE INDEX IF NOT EXISTS idx_GameFileList_gameID "
+        "ON GameFileList(gameID)",
+    }},
+    {"0.0.3", {
+        // Full-text index of the level cards and pages, rowid is LevelID
+        "CREATE VIRTUAL TABLE IF NOT EXISTS LevelSearch USING fts5("
+        "    title, authors, body, walkthrough, trleID UNINDEXED,"
+        "    tokenize = 'unicode61 remove_diacritics 2')",
+        "DELETE FROM LevelSearch",
+        "INSERT INTO LevelSearch"
+        "    (rowid, title, authors, body, walkthrough, trleID) "
+        "SELECT Level.LevelID, Info.title, ("
+        "    SELECT GROUP_CONCAT(Author.value, ', ') "
+        "    FROM AuthorList "
+        "    JOIN Author ON AuthorList.authorID = Author.AuthorID "
+        "    WHERE AuthorList.levelID = Level.LevelID), "
+        "Level.body, Level.walkthrough, Info.trleID "
+        "FROM Level "
+        "JOIN Info ON Level.infoID = Info.InfoID",
+        // Keep it in sync with the writes from tombll_manage_data.py
+        "CREATE TRIGGER IF NOT EXISTS LevelSearch_Level_ai "
+        "AFTER INSERT ON Level BEGIN "
+        LEVEL_SEARCH_REFRESH("WHERE Level.LevelID = NEW.LevelID")
+        " END",
+        "CREATE TRIGGER IF NOT EXISTS LevelSearch_Level_au "
+        "AFTER UPDATE ON Level BEGIN "
+        LEVEL_SEARCH_REFRESH("WHERE Level.LevelID = NEW.LevelID")
+        " END",
+        "CREATE TRIGGER IF NOT EXISTS LevelSearch_Level_ad "
+        "AFTER DELETE ON Level BEGIN "
+        "DELETE FROM LevelSearch WHERE rowid = OLD.LevelID; "
+        "END",
+        "CREATE TRIGGER IF NOT EXISTS LevelSearch_Info_au "
+        "AFTER UPDATE ON Info BEGIN "
+        LEVEL_SEARCH_REFRESH("WHERE Level.infoID = NEW.InfoID")
+        " END",
+        "CREATE TRIGGER IF NOT EXISTS LevelSearch_AuthorList_ai "
+        "AFTER INSERT ON AuthorList BEGIN "
+        LEVEL_SEARCH_REFRESH("WHERE Level.LevelID = NEW.levelID")
+        " END",
+        "CREATE TRIGGER IF NOT EXISTS LevelSearch_AuthorList_ad "
+        "AFTER DELETE ON AuthorList BEGIN "
+        LEVEL_SEARCH_REFRESH("WHERE Level.LevelID = OLD.levelID")
+        " END",
+    }},
+    {"0.0.4", {
+        // Keyset pagination of the level list
+        "CREATE INDEX IF NOT EXISTS idx_Info_release_trleID "
+        "ON Info(release DESC, trleID DESC)",
+    }},
+    {"0.0.5", {
+        // Shared zstd dictionaries, 'level_text' for Level.body and
+        // Level.walkthrough written by tombll_manage_data.py -z
+        "CREATE TABLE IF NOT EXISTS Dictionary ("
+        "    DictionaryID INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL,"
+        "    name TEXT UNIQUE NOT NULL,"
+        "    data BLOB NOT NULL)",
+        "DROP TRIGGER IF EXISTS LevelSearch_Level_ai",
+        "DROP TRIGGER IF EXISTS LevelSearch_Level_au",
+        "DROP TRIGGER IF EXISTS LevelSearch_Info_au",
+        "DROP TRIGGER IF EXISTS LevelSearch_AuthorList_ai",
+        "DROP TRIGGER IF EXISTS LevelSearch_AuthorList_ad",
+        "CREATE TRIGGER LevelSearch_Level_ai "
+        "AFTER INSERT ON Level BEGIN "
+        LEVEL_SEARCH_UPSERT("WHERE Level.LevelID = NEW.LevelID")
+        " END",
+        "CREATE TRIGGER LevelSearch_Level_au "
+        "AFTER UPDATE ON Level BEGIN "
+        LEVEL_SEARCH_UPSERT("WHERE Level.LevelID = NEW.LevelID")
+        " END",
+        "CREATE TRIGGER LevelSearch_Info_au "
+        "AFTER UPDATE ON Info BEGIN "
+        LEVEL_SEARCH_UPSERT("WHERE Level.infoID = NEW.InfoID")
+        " END",
+        "CREATE TRIGGER LevelSearch_AuthorList_ai "
+        "AFTER INSERT ON AuthorList BEGIN "
+        LEVEL_SEARCH_UPSERT("WHERE Level.LevelID = NEW.levelID")
+        " END",
+        "CREATE TRIGGER LevelSearch_AuthorList_ad "
+        "AFTER DELETE ON AuthorList BEGIN "
+        LEVEL_SEARCH_UPSERT("WHERE Level.LevelID = OLD.levelID")
+        " END",
+    }},
+    {"0.0.6", {
+        // Where tombll_manage_data.py -pk put each Picture in pictures.pack,
+        // a packed Picture keeps an empty data BLOB
+        "CREATE TABLE IF NOT EXISTS PicturePack ("
+        "    md5sum TEXT PRIMARY KEY NOT NULL,"
+        "    offset INTEGER NOT NULL,"
+        "    size INTEGER NOT NULL) WITHOUT ROWID",
+    }},
+    {"0.0.7", {
+        // Hashes of files on disk by inode, valid while size and mtime match
+        "CREATE TABLE IF NOT EXISTS FileHash ("
+        "    device INTEGER NOT NULL,"
+        "    inode INTEGER NOT NULL,"
+        "    size INTEGER NOT NULL,"
+        "    mtimeNs INTEGER NOT NULL,"
+        "    md5sum TEXT NOT NULL,"
+        "    blake2b TEXT NOT NULL,"
+        "    PRIMARY KEY (device, inode)) WITHOUT ROWID",
+    }},
+    {"0.0.8", {
+        // Pack generation the PicturePack offsets point into, written by
+        // tombll_manage_data.py -pc in the same commit as the offsets
+        "CREATE TABLE IF NOT EXISTS PicturePackFile ("
+        "    generation INTEGER NOT NULL)",
+    }},
+};
+#undef LEVEL_SEARCH_REFRESH
+#undef LEVEL_SEARCH_UPSERT
+}  // namespace
+
+bool Data::migrateDatabase() {
+    bool status = false;
+    runOnWriter([this, &status]() {
+        status = applyMigrations();
+    });
+    return status;
+}
+
+bool Data::applyMigrations() {
+    QSqlDatabase& db = getThreadDatabase();
+    bool status = db.isOpen();
+    QVersionNumber current;
+    QVersionNumber first;
+
+    if (status == true) {
+        QSqlQuery query(db);
+        if (query.exec("SELECT value FROM Version WHERE id = 1") &&
+                query.next()) {
+            current = QVersionNumber::fromString(query.value(0).toString());
+            first = current;
+        } else {
+            qCritical() << "Error reading database version:"
+                << query.lastError().text();
+            status = false;
+        }
+    } else {
+        qCritical() << "Error opening database:" << db.lastError().text();
+    }
+
+    for (const Migration& migration : migrations) {
+        const QVersionNumber target =
+            QVersionNumber::fromString(migration.version);
+        if ((status == false) || (target <= current)) {
+            continue;
+        }
+
+        status = db.transaction();
+        QSqlQuery query(db);
+        for (const QString& statement : migration.statements) {
+            if (status && !query.exec(statement)) {
+                qCritical() << "Error migrating database to"
+                    << migration.version << ":" << query.lastError().text();
+                status = false;
+            }
+        }
+
+        if (status == true) {
+            status = query.prepare(
+                "UPDATE Version SET value = :value WHERE id = 1");
+            query.bindValue(":value", migration.version);
+            status = status && query.exec();
+        }
+
+        if ((status == true) && (db.commit() == true)) {
+            qDebug() << "Database migrated from" << current.toString()
+                     << "to" << migration.version;
+            current = target;
+        } else {
+            (void)db.rollback();
+            status = false;
+        }
+    }
+
+    if ((status == true) && (first < QVersionNumber(0, 0, 5))) {
+        status = indexLevelText();
+    }
+
+    return status;
+}
+
+bool Data::indexLevelText() {
+    QSqlDatabase& db = getThreadDatabase();
+    QSqlQuery select(db);
+    QSqlQuery update(db);
+    qint64 count = 0;
+
+    bool status = db.transaction();
+    status = status && select.exec(
+        "SELECT LevelID, body, walkthrough "
+        "FROM Level "
+        "WHERE typeof(body) = 'blob' OR typeof(walkthrough) = 'blob'");
+    status = status && update.prepare(
+        "UPDATE LevelSearch "
+        "SET body = :body, walkthrough = :walkthrough "
+        "WHERE rowid = :id");
+
+    while ((status == true) && (select.next() == true)) {
+        update.bindValue(":body", decodeLevelText(select.value(1)));
+        update.bindValue(":walkthrough", decodeLevelText(select.value(2)));
+        update.bindValue(":id", select.value(0));
+        status = update.exec();
+        count++;
+    }
+    select.finish();
+
+    if ((status == true) && (db.commit() == true)) {
+        qDebug() << "Indexed the text of" << count << "compressed levels";
+    } else {
+        qCritical() << "Error indexing compressed levels:"
+            << select.lastError().text() << update.lastError().text();
+        (void)db.rollback();
+        status = false;
+    }
+    return status;
+}
+
+QByteArray Data::getPictureData(const QSqlQuery& query, const int column) {
+    if (!query.isNull(column + 1) && m_picturePack.isOpen()) {
+        const QByteArray data = m_picturePack.span(
+            query.value(column + 1).toLongLong(),
+            query.value(column + 2).toLongLong());
+        if (!data.isEmpty()) {
+            return data;
+        }
+    }
+    return query.value(column).toByteArray();
+}
+
+const ZSTD_DDict* Data::getLevelTextDictionary() {
+    // Before the lock, a thread holding the lock never waits for a slot
+    ReadSlot slot(this);
+    QMutexLocker locker(&m_levelTextDictMutex);
+
+    if (m_levelTextDictLoaded == false) {
+        m_levelTextDictLoaded = true;
+        QSqlQuery* query = getStatement(Statement::LevelTextDictionary);
+        QueryTimer timer("LevelTextDictionary", query);
+        if (query != nullptr) {
+            if ((query->exec() == true) && (query->next() == true)) {
+                const QByteArray dict = query->value(0).toByteArray();
+                timer.addRow();
+                timer.addBytes(dict.size());
+                m_levelTextDict =
+                    ZSTD_createDDict(dict.constData(), dict.size());
+                if (m_levelTextDict != nullptr) {
+                    qDebug() << "Loaded level text dictionary, id"
+                        << ZSTD_getDictID_fromDDict(m_levelTextDict)
+                        << "," << dict.size() << "bytes";
+                } else {
+                    qWarning() << "Invalid level text dictionary";
+                }
+            } else {
+                qDebug() << "No level text dictionary";
+            }
+            query->finish();
+        }
+    }
+    return m_levelTextDict;
+}
+
+QString Data::decodeLevelText(const QVariant& value) {
+    if (value.typeId() != QMetaType::QByteArray) {
+        return value.toString();
+    }
+
+    const QByteArray frame = value.toByteArray();
+    if ((frame.size() < 4) ||
+            (qFromLittleEndian<quint32>(frame.constData()) !=
+                ZSTD_MAGICNUMBER)) {
+        return QString::fromUtf8(frame);
+    }
+
+    // In the query stats next to the reads, bytes are the decoded size
+    QueryTimer timer("LevelTextDecode");
+
+    const unsigned long long size =
+        ZSTD_getFrameContentSize(frame.constData(), frame.size());
+    if ((size == ZSTD_CONTENTSIZE_ERROR) ||
+            (size == ZSTD_CONTENTSIZE_UNKNOWN) ||
+            (size > levelTextMaxSize)) {
+        qWarning() << "Invalid level text frame size:" << size;
+        return QString();
+    }
+
+    QByteArray text(static_cast<qsizetype>(size), Qt::Uninitialized);
+    const ZSTD_DDict* dict = getLevelTextDictionary();
+    ZSTD_DCtx* context = getThreadDecompressContext();
+    size_t result;
+    if (dict != nullptr) {
+        result = ZSTD_decompress_usingDDict(context,
+                text.data(), text.size(),
+                frame.constData(), frame.size(), dict);
+    } else {
+        result = ZSTD_decompressDCtx(context,
+                text.data(), text.size(),
+                frame.constData(), frame.size());
+    }
+
+    if (ZSTD_isError(result)) {
+        qWarning() << "Error decompressing level text:"
+            << ZSTD_getErrorName(result);
+        return QString();
+    }
+
+    timer.addRow();
+    timer.addBytes(static_cast<qint64>(result));
+    return QString::fromUtf8(text.constData(), result);
+}
+
+QString Data::getStatementSql(const Statement key) const {
+    static_assert(std::size(statementSql) ==
+            static_cast<size_t>(Statement::Count),
+            "statementSql must have one entry per Data::Statement");
+
+    QString sql = QString::fromLatin1(statementSql[static_cast<qint64>(key)]);
+    if ((key == Statement::CoverMd5Batch) ||
+            (key == Statement::CoverDataBatch)) {
+        QStringList placeholders;
+        for (qint64 i = 0; i < m_coverBatchLimit; i++) {
+            placeholders << "?";
+        }
+        sql = sql.arg(placeholders.join(", "));
+    }
+    return sql;
+}
+
+Data::Data() {
+    m_writerThread.setObjectName("DatabaseWriter");
+    m_writerContext.moveToThread(&m_writerThread);
+}
+
+Data::~Data() {
+    // The writer connection is closed by the thread as it ends
+    m_writerThread.quit();
+    (void)m_writerThread.wait();
+    ZSTD_freeDDict(m_levelTextDict);
+}
+
+namespace {
+
+// Reads of this thread in progress, only the outermost takes a slot
+thread_local int readDepth = 0;
+
+}  // namespace
+
+Data::ReadSlot::ReadSlot(Data* data) :
+        m_data(data),
+        m_held(false) {
+    if ((readDepth++ == 0) &&
+            (QThread::currentThread() != &data->m_writerThread)) {
+        if (data->m_readerSlots.tryAcquire() == false) {
+            QElapsedTimer timer;
+            timer.start();
+            data->m_readerSlots.acquire();
+            const qint64 waited = timer.nsecsElapsed();
+            data->m_poolWaits++;
+            data->m_poolWaitNs += waited;
+            qDebug() << "Connection pool: read waited"
+                     << waited / 1000000 << "ms for a reader slot";
+        }
+        m_held = true;
+    }
+}
+
+Data::ReadSlot::~ReadSlot() {
+    readDepth--;
+    if (m_held == true) {
+        m_data->m_readerSlots.release();
+    }
+}
+
+Data::ThreadConnection::~ThreadConnection() {
+    if (!connection.isNull()) {
+        owner->closeConnection(connection.data());
+    }
+}
+
+Data::Connection& Data::getThreadConnection() {
+    thread_local ThreadConnection local;
+    if (local.connection.isNull()) {
+        local.owner = this;
+        local.connection =
+            openConnection(QThread::currentThread() == &m_writerThread);
+    }
+    return *local.connection;
+}
+
+QSharedPointer<Data::Connection> Data::openConnection(const bool writer) {
+    auto connection = QSharedPointer<Connection>::create();
+    connection->writer = writer;
+    connection->name = QString("%1_%2")
+        .arg(writer ? "writer" : "reader")
+        .arg(m_connectionSerial++);
+
+    connection->db = QSqlDatabase::addDatabase("QSQLITE", connection->name);
+    connection->db.setDatabaseName(m_path.get());
+    connection->db.setConnectOptions(writer
+        ? "QSQLITE_BUSY_TIMEOUT=5000"
+        : "QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000");
+
+    if (connection->db.open() == true) {
+        QSqlQuery query(connection->db);
+        for (const QString& pragma : writer ? writerPragmas : readerPragmas) {
+            if (!query.exec(pragma)) {
+                qDebug() << "Error setting" << pragma << ":"
+                    << query.lastError().text();
+            }
+        }
+    } else {
+        qCritical() << "Error opening database connection" << connection->name
+            << ":" << connection->db.lastError().text();
+    }
+
+    connection->statements.resize(static_cast<qint64>(Statement::Count));
+    qDebug() << "Connection pool: opened" << connection->name << "on"
+             << QThread::currentThread()->objectName();
+    return connection;
+}
+
+void Data::closeConnection(Connection* connection) {
+    // Queries and the handle must be gone before the connection is removed
+    connection->statements.clear();
+    connection->db.close();
+    connection->db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connection->name);
+    qDebug() << "Connection pool: closed" << connection->name;
+}
+
+void Data::runOnWriter(const std::function<void()>& task) {
+    if (QThread::currentThread() == &m_writerThread) {
+        task();
+        return;
+    }
+
+    static QMutex startMutex;
+    {
+        QMutexLocker locker(&startMutex);
+        if (!m_writerThread.isRunning()) {
+            m_writerThread.start();
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QMetaObject::invokeMethod(&m_writerContext, [this, &task, &timer]() {
+        // Time spent queued behind other writes
+        const qint64 waited = timer.nsecsElapsed();
+        if (waited > 1000000) {
+            m_poolWaits++;
+            m_poolWaitNs += waited;
+            qDebug() << "Connection pool: write waited"
+                     << waited / 1000000 << "ms for the writer";
+        }
+        task();
+    }, Qt::BlockingQueuedConnection);
+}
+
+QStringList Data::getQueryPlan(const Statement key) {
+    static const QRegularExpression placeholder("(:\\w+|\\?)");
+    QString sql = getStatementSql(key);
+    sql.replace(placeholder, "1");
+
+    QStringList plan;
+    ReadSlot slot(this);
+    QSqlQuery query(getThreadDatabase());
+    if (query.exec(QString("EXPLAIN QUERY PLAN %1").arg(sql)) == true) {
+        while (query.next() == true) {
+            plan << query.value("detail").toString();
+        }
+    } else {
+        qDebug() << "Error explaining query:" << query.lastError().text();
+    }
+    return plan;
+}
+
+QSqlQuery* Data::getStatement(const Statement key) {
+    const qint64 index = static_cast<qint64>(key);
+    Connection& connection = getThreadConnection();
+    QSharedPointer<QSqlQuery>& statement = connection.statements[index];
+
+    if (statement.isNull()) {
+        auto query = QSharedPointer<QSqlQuery>::create(connection.db);
+        query->setForwardOnly(true);
+        if (query->prepare(getStatementSql(key)) == true) {
+            statement = query;
+        } else {
+            qDebug() << "Error preparing statement" << index << ":"
+                << query->lastError().text();
+        }
+        m_statementMisses++;
+        qDebug() << "Statement cache: prepared" << index
+                 << "hits" << m_statementHits.load()
+                 << "misses" << m_statementMisses.load();
+    } else {
+        m_statementHits++;
+    }
+
+    return statement.data();
+}
+
+void Data::bindCoverBatch(QSqlQuery* query, const QVector<qint64>& ids) {
+    Q_ASSERT_WITH_TRACE(ids.size() <= m_coverBatchLimit);
+    for (qint64 i = 0; i < m_coverBatchLimit; i++) {
+        if (i < ids.size()) {
+            query->bindValue(i, ids.at(i));
+        } else {
+            query->bindValue(i, QVariant());
+        }
+    }
+}
 
 qint64 Data::getListRowCount() {
-    QSqlDatabase db = getThreadDatabase();
-    QSqlQuery query(db);
+    ReadSlot slot(this);
+    QSqlQuery* query = getStatement(Statement::ListRowCount);
+    QueryTimer timer("ListRowCount", query);
     qint64 result = 0;
 
-    if (query.prepare("SELECT COUNT(*) FROM Level") == true) {
-        if (query.exec() == true) {
+    if (query != nullptr) {
+        if (query->exec() == true) {
             // Move to the first (and only) result row
-            if (query.next() == true) {
+            if (query->next() == true) {
+                timer.addRow();
                 // Assign the count value to result
-                result = query.value(0).toInt();
+                result = query->value(0).toInt();
                 qWarning() << "Number of rows in 'Level' table:" << result;
             } else {
                 qDebug() << "No rows returned from the query";
             }
         } else {
-            qDebug() << "Error executing query:" << query.lastError().text();
+            qDebug() << "Error executing query:" << query->lastError().text();
         }
-    } else {
-        qDebug() << "Error preparing query:" << query.lastError().text();
+        query->finish();
     }
     return result;
 }
 
-QVector<QSharedPointer<ListItemData>> Data::getListItems() {
-    QSqlDatabase db = getThreadDatabase();
-    QSqlQuery query(db);
-    bool status = true;
+QVector<QSharedPointer<ListItemData>> Data::getListPage(
+        const QString& release, const qint64 trleId, const qint64 limit) {
+    ReadSlot slot(this);
+    QSqlQuery* query = getStatement(Statement::ListItems);
+    QueryTimer timer("ListItems", query);
     QVector<QSharedPointer<ListItemData>> items;
+    items.reserve(limit);
 
-    status = query.prepare(
-            "SELECT Info.trleID, "
-            "Info.title, "
-            "GROUP_CONCAT(Author.value, ', ') AS authors, "
-            "Info.type, "
-            "Info.class, "
-            "Info.release, "
-            "Info.difficulty, "
-            "Info.duration "
-            "FROM Level "
-            "JOIN Info ON Level.infoID = Info.InfoID "
-            "JOIN AuthorList ON Level.LevelID = AuthorList.levelID "
-            "JOIN Author ON AuthorList.authorID = Author.AuthorID "
-            "GROUP BY Info.trleID "
-            "ORDER BY Info.release DESC");
-    if (!status) {
-        qDebug() << "Error preparing query getListItems:"
-            << query.lastError().text();
-    }
-
-    if (status) {
-        if (query.exec()) {
-            while (query.next()) {
+    if (query != nullptr) {
+        query->bindValue(":release", release);
+        query->bindValue(":id", trleId);
+        query->bindValue(":limit", limit);
+        if (query->exec()) {
+            while (query->next()) {
                 auto item = QSharedPointer<ListItemData>::create();
-                item->setLid(query.value("Info.trleID").toInt());
-                item->setTitle(query.value("Info.title").toString());
-                item->setAuthors(query.value("authors").toString().split(", "));
-                item->setType(query.value("Info.type").toInt());
-                item->setClass(query.value("Info.class").toInt());
-                item->setDifficulty(query.value("Info.difficulty").toInt());
-                item->setDuration(query.value("Info.duration").toInt());
-                item->setReleaseDate(query.value("Info.release").toString());
+                item->setLid(query->value("Info.trleID").toInt());
+                item->setTitle(query->value("Info.title").toString());
+                item->setAuthors(
+                        query->value("authors").toString().split(", "));
+                item->setType(query->value("Info.type").toInt());
+                item->setClass(query->value("Info.class").toInt());
+                item->setDifficulty(query->value("Info.difficulty").toInt());
+                item->setDuration(query->value("Info.duration").toInt());
+                item->setReleaseDate(query->value("Info.release").toString());
                 items.append(item);
+                timer.addRow();
+                timer.addBytes(item->m_title.size() * sizeof(QChar));
             }
         } else {
-            qDebug() << "Error executing query getListItems:"
-                << query.lastError().text();
+            qDebug() << "Error executing query getListPage:"
+                << query->lastError().text();
         }
+        query->finish();
     }
 
     return items;
 }
 
 void Data::getCoverPictures(QVector<QSharedPointer<ListItemData>> items) {
-    QSqlDatabase db = getThreadDatabase();
-    QSqlQuery query(db);
+    QElapsedTimer timer;
+    timer.start();
 
-    bool status = query.prepare(
-        "SELECT Picture.data "
-        "FROM Level "
-        "JOIN Info ON Level.infoID = Info.InfoID "
-        "JOIN Screens ON Level.LevelID = Screens.levelID "
-        "JOIN Picture ON Screens.pictureID = Picture.PictureID "
-        "WHERE Info.trleID = :id AND Screens.position = 0 ");
-    if (!status) {
-        qDebug() << "Error preparing query getPictures:"
-            << query.lastError().text();
-    }
-
-    if (status) {
-        for (QSharedPointer<ListItemData>& item : items) {
-            if (item->m_cover.isNull()) {
-                query.bindValue(":id", item->m_trle_id);
-                if (query.exec()) {
-                    if (query.next() == true) {
-                        item->setPicture(
-                                query.value("Picture.data").toByteArray());
+    // Only ask for covers we don't have, one row per trle.net lid
+    QHash<qint64, QSharedPointer<ListItemData>> pending;
+    QVector<qint64> ids;
+    for (const QSharedPointer<ListItemData>& item : items) {
+        if (item->m_cover.isNull() && !pending.contains(item->m_trle_id)) {
+            pending.insert(item->m_trle_id, item);
+            ids.append(item->m_trle_id);
+        }
+    }
+
+    qint64 queries = 0;
+    qint64 atlasHits = 0;
+    qint64 decoded = 0;
+
+    for (qint64 offset = 0; offset < ids.size(); offset += m_coverBatchLimit) {
+        const QVector<qint64> batch = ids.mid(offset, m_coverBatchLimit);
+
+        // First pass only reads checksums, the atlas has most covers
+        QHash<qint64, QString> misses;
+        {
+            // Reader slot only for the query, not the decode below
+            ReadSlot slot(this);
+            QSqlQuery* query = getStatement(Statement::CoverMd5Batch);
+            if (query == nullptr) {
+                break;
+            }
+            bindCoverBatch(query, batch);
+            queries++;
+            QueryTimer md5Timer("CoverMd5Batch", query);
+            if (query->exec()) {
+                while (query->next() == true) {
+                    md5Timer.addRow();
+                    const qint64 id = query->value(0).toLongLong();
+                    const QString md5sum = query->value(1).toString();
+                    QImage tile;
+                    if (m_coverAtlas.lookup(id, md5sum, &tile)) {
+                        QSharedPointer<ListItemData> item = pending.take(id);
+                        if (!item.isNull()) {
+                            item->setCoverTile(tile);
+                            atlasHits++;
+                        }
+                    } else {
+                        misses.insert(id, md5sum);
                     }
-                } else {
-                    qDebug() << "Error executing query getPictures:"
-                        << query.lastError().text();
                 }
+            } else {
+                qDebug() << "Error executing query getPictures:"
+                    << query->lastError().text();
+            }
+            query->finish();
+        }
+
+        if (misses.isEmpty()) {
+            continue;
+        }
+
+        // Second pass reads and decodes the picture data for the misses
+        QVector<QPair<qint64, QByteArray>> pictures;
+        {
+            ReadSlot slot(this);
+            QSqlQuery* dataQuery = getStatement(Statement::CoverDataBatch);
+            if (dataQuery == nullptr) {
+                break;
+            }
+            bindCoverBatch(dataQuery, misses.keys());
+            queries++;
+            QueryTimer dataTimer("CoverDataBatch", dataQuery);
+            if (dataQuery->exec()) {
+                while (dataQuery->next() == true) {
+                    dataTimer.addRow();
+                    pictures.append({dataQuery->value(0).toLongLong(),
+                        getPictureData(*dataQuery, 1)});
+                    dataTimer.addBytes(pictures.last().second.size());
+                }
+            } else {
+                qDebug() << "Error executing query getPictures:"
+                    << dataQuery->lastError().text();
+            }
+            dataQuery->finish();
+        }
+
+        // Decode after the read so the query time is only the query
+        for (const QPair<qint64, QByteArray>& picture : pictures) {
+            QSharedPointer<ListItemData> item = pending.take(picture.first);
+            if (!item.isNull()) {
+                const QImage tile = CoverAtlas::makeTile(picture.second);
+                (void)m_coverAtlas.store(
+                    picture.first, misses.value(picture.first), tile);
+                item->setCoverTile(tile);
+                decoded++;
             }
         }
     }
+
+    qDebug() << "getCoverPictures:" << (atlasHits + decoded) << "of"
+             << ids.size() << "covers," << atlasHits << "from atlas,"
+             << decoded << "decoded, in" << queries << "queries,"
+             << timer.elapsed() << "ms";
 }
 
 InfoData Data::getInfo(const int id) {
-    QSqlDatabase db = getThreadDatabase();
-    QSqlQuery query(db);
-    bool status = false;
+    ReadSlot slot(this);
+    QSqlQuery* query = getStatement(Statement::Info);
+    QueryTimer timer("Info", query);
     InfoData result;
 
-    status = query.prepare(
-        "SELECT Level.body, Picture.data "
-        "FROM Level "
-        "JOIN Info ON Level.infoID = Info.InfoID "
-        "LEFT JOIN Screens "
-        "    ON Level.LevelID = Screens.levelID "
-        "    AND Screens.position > 0 "
-        "LEFT JOIN Picture "
-        "    ON Screens.pictureID = Picture.PictureID "
-        "WHERE Info.trleID = :id "
-        "ORDER BY Screens.position ASC");
-    query.bindValue(":id", id);
-
-    if (status) {
-        if ((query.exec() == true) && (query.next() == true)) {
+    if (query != nullptr) {
+        query->bindValue(":id", id);
+        if ((query->exec() == true) && (query->next() == true)) {
             QVector<QByteArray> imageList;
-            QString body = query.value("body").toString();
+            QString body = decodeLevelText(query->value("body"));
+            timer.addBytes(body.size() * sizeof(QChar));
 
             do {
-                QVariant picVar = query.value("data");
-                if (!picVar.isNull())
-                    imageList.push_back(picVar.toByteArray());
-            } while (query.next());
+                timer.addRow();
+                if (!query->isNull(1)) {
+                    imageList.push_back(getPictureData(*query, 1));
+                    timer.addBytes(imageList.last().size());
+                }
+            } while (query->next());
 
             result = InfoData(body, imageList);
         } else {
-            qDebug() << "Error executing query:" << query.lastError().text();
+            qDebug() << "Error executing query:" << query->lastError().text();
         }
+        query->finish();
     }
     return result;
 }
 
 QString Data::getWalkthrough(const int id) {
-    QSqlDatabase db = getThreadDatabase();
-    QSqlQuery query(db);
-    bool status = false;
+    ReadSlot slot(this);
+    QSqlQuery* query = getStatement(Statement::Walkthrough);
+    QueryTimer timer("Walkthrough", query);
     QString result = "";
 
-    status = query.prepare(
-        "SELECT Level.walkthrough "
-        "FROM Level "
-        "JOIN Info ON Level.infoID = Info.InfoID "
-        "WHERE Info.trleID = :id");
-    query.bindValue(":id", id);
-
-    if (status) {
-        if (query.exec() == true) {
-            if (query.next() == true) {
-                result = query.value("Level.walkthrough").toString();
+    if (query != nullptr) {
+        query->bindValue(":id", id);
+        if (query->exec() == true) {
+            if (query->next() == true) {
+                result = decodeLevelText(
+                    query->value("Level.walkthrough"));
+                timer.addRow();
+                timer.addBytes(result.size() * sizeof(QChar));
             } else {
                 qDebug() << "No results found for Level ID:" << id;
             }
         } else {
-            qDebug() << "Error executing query:" << query.lastError().text();
+            qDebug() << "Error executing query:" << query->lastError().text();
         }
+        query->finish();
     }
     return result;
 }
 
 int Data::getType(const int id) {
-    QSqlDatabase db = getThreadDatabase();
-    QSqlQuery query(db);
-    bool status = false;
+    ReadSlot slot(this);
+    QSqlQuery* query = getStatement(Statement::Type);
+    QueryTimer timer("Type", query);
     int result = 0;
 
-    status = query.prepare(
-        "SELECT Info.type "
-        "FROM Info "
-        "WHERE Info.trleID = :id");
-    query.bindValue(":id", id);
-
-    if (status) {
-        if (query.exec() == true) {
-            if (query.next() == true) {
-                result = query.value("Info.type").toInt();
+    if (query != nullptr) {
+        query->bindValue(":id", id);
+        if (query->exec() == true) {
+            if (query->next() == true) {
+                result = query->value("Info.type").toInt();
+                timer.addRow();
             } else {
                 qDebug() << "No results found for Level ID:" << id;
             }
         } else {
-            qDebug() << "Error executing query:" << query.lastError().text();
+            qDebug() << "Error executing query:" << query->lastError().text();
         }
+        query->finish();
     }
     return result;
 }
 
 ZipData Data::getDownload(const int id) {
-    QSqlDatabase db = getThreadDatabase();
-    QSqlQuery query(db);
-    bool status = false;
+    ReadSlot slot(this);
+    QSqlQuery* query = getStatement(Statement::Download);
+    QueryTimer timer("Download", query);
     ZipData result;
 
-    status = query.prepare(
-        "SELECT Zip.*, Info.type "
-        "FROM Level "
-        "JOIN Info ON Level.infoID = Info.InfoID "
-        "JOIN ZipList ON Level.LevelID = ZipList.levelID "
-        "JOIN Zip ON ZipList.zipID = Zip.ZipID "
-        "WHERE Info.trleID = :id");
-    query.bindValue(":id", id);
-
-    if (status) {
-        if (query.exec() == true) {
-            if (query.next() == true) {
-                result.setFileName(query.value("Zip.name").toString());
-                result.setMebibyteSize(query.value("Zip.size").toFloat());
-                result.setMD5sum(query.value("Zip.md5sum").toString());
-                result.setURL(query.value("Zip.url").toString());
-                result.setVersion(query.value("Zip.version").toInt());
-                result.setType(query.value("Info.type").toInt());
+    if (query != nullptr) {
+        query->bindValue(":id", id);
+        if (query->exec() == true) {
+            if (query->next() == true) {
+                result.setFileName(query->value("Zip.name").toString());
+                result.setMebibyteSize(query->value("Zip.size").toFloat());
+                result.setMD5sum(query->value("Zip.md5sum").toString());
+                result.setURL(query->value("Zip.url").toString());
+                result.setVersion(query->value("Zip.version").toInt());
+                result.setType(query->value("Info.type").toInt());
                 result.setId(id);
-                result.setRelease(query.value("Zip.release").toString());
+                result.setRelease(query->value("Zip.release").toString());
+                timer.addRow();
             } else {
                 qDebug() << "No results found for Level ID:" << id;
             }
         } else {
-            qDebug() << "Error executing query:" << query.lastError().text();
+            qDebug() << "Error executing query:" << query->lastError().text();
         }
+        query->finish();
     }
     return result;
 }
 
 void Data::setDownloadMd5(const int id, const QString& newMd5sum) {
-    QSqlDatabase db = getThreadDatabase();
+    runOnWriter([this, id, &newMd5sum]() {
+        QSqlQuery* query = getStatement(Statement::SetDownloadMd5);
+        QueryTimer timer("SetDownloadMd5", query);
+
+        if (query != nullptr) {
+            query->bindValue(":newMd5sum", newMd5sum);
+            query->bindValue(":id", id);
+
+            if (!query->exec()) {
+                qDebug() << "Error executing query:"
+                    << query->lastError().text();
+            } else {
+                qDebug() << "md5sum updated successfully.";
+            }
+            query->finish();
+        }
+    });
+}
+
+qint64 Data::getPicturePackGeneration() {
+    ReadSlot slot(this);
+    QSqlQuery* query = getStatement(Statement::PicturePackGeneration);
+    QueryTimer timer("PicturePackGeneration", query);
+    qint64 generation = 0;
+
+    if (query != nullptr) {
+        if (query->exec() == true) {
+            if (query->next() == true) {
+                generation = query->value(0).toLongLong();
+                timer.addRow();
+            }
+        } else {
+            qDebug() << "Error executing query:" << query->lastError().text();
+        }
+        query->finish();
+    }
+    return generation;
+}
+
+bool Data::getFileHash(const FileHashKey& key,
+        QString* md5sum, QString* blake2b) {
+    ReadSlot slot(this);
+    QSqlQuery* query = getStatement(Statement::FileHashLookup);
+    QueryTimer timer("FileHashLookup", query);
     bool status = false;
-    QSqlQuery query(db);
-
-    status = query.prepare(
-        "UPDATE Zip "
-        "SET md5sum = :newMd5sum "
-        "WHERE Zip.ZipID IN ("
-        "    SELECT ZipList.zipID"
-        "    FROM Level"
-        "    JOIN Info ON Level.infoID = Info.InfoID"
-        "    JOIN ZipList ON Level.LevelID = ZipList.levelID"
-        "    WHERE Info.trleID = :id)");
-
-    if (status) {
-        query.bindValue(":newMd5sum", newMd5sum);
-        query.bindValue(":id", id);
-
-        if (!query.exec()) {
-            qDebug() << "Error executing query:" << query.lastError().text();
+
+    if (query != nullptr) {
+        query->bindValue(":device", key.device);
+        query->bindValue(":inode", key.inode);
+        query->bindValue(":size", key.size);
+        query->bindValue(":mtimeNs", key.mtimeNs);
+        if (query->exec() == true) {
+            if (query->next() == true) {
+                *md5sum = query->value(0).toString();
+                *blake2b = query->value(1).toString();
+                timer.addRow();
+                status = true;
+            }
         } else {
-            qDebug() << "md5sum updated successfully.";
+            qDebug() << "Error executing query:" << query->lastError().text();
         }
-    } else {
-        qDebug() << "Error preparing query:" << query.lastError().text();
+        query->finish();
     }
+    return status;
+}
+
+void Data::setFileHash(const FileHashKey& key,
+        const QString& md5sum, const QString& blake2b) {
+    runOnWriter([this, &key, &md5sum, &blake2b]() {
+        QSqlQuery* query = getStatement(Statement::FileHashStore);
+        QueryTimer timer("FileHashStore", query);
+
+        if (query != nullptr) {
+            query->bindValue(":device", key.device);
+            query->bindValue(":inode", key.inode);
+            query->bindValue(":size", key.size);
+            query->bindValue(":mtimeNs", key.mtimeNs);
+            query->bindValue(":md5sum", md5sum);
+            query->bindValue(":blake2b", blake2b);
+            if (!query->exec()) {
+                qDebug() << "Error executing query:"
+                    << query->lastError().text();
+            }
+            query->finish();
+        }
+    });
 }
 
 QVector<FileListItem> Data::getFileList(const int id) {
-    QSqlDatabase db = getThreadDatabase();
-    QSqlQuery query(db);
+    ReadSlot slot(this);
+    QSqlQuery* query = getStatement(Statement::FileList);
+    QueryTimer timer("FileList", query);
     QVector<FileListItem> list;
 
-    if (!query.prepare(
-            "SELECT File.path, File.md5sum "
-            "FROM File "
-            "JOIN GameFileList ON File.FileID = GameFileList.fileID "
-            "WHERE GameFileList.gameID = :id")) {
-        qDebug() << "Error preparing query:" << query.lastError().text();
+    if (query != nullptr) {
+        query->bindValue(":id", id);
+        if (query->exec() == true) {
+            while (query->next() == true) {
+                list.append({
+                    query->value("path").toString(),
+                    query->value("md5sum").toString()});
+                timer.addRow();
+            }
+        } else {
+            qDebug() << "Error executing query:" << query->lastError().text();
+        }
+        query->finish();
     }
-    query.bindValue(":id", id);
+    return list;
+}
 
-    if (query.exec() == true) {
-        while (query.next() == true) {
-            list.append({
-                query.value("path").toString(),
-                query.value("md5sum").toString()});
+QVector<qint64> Data::searchLevels(
+        const QString& text, const SearchScope scope) {
+    static const QRegularExpression space("\\s+");
+    static const QStringList columns = {
+        "{title}",
+        "{authors}",
+        "{body walkthrough}"
+    };
+
+    // Quote every word so FTS5 operators typed by the user are just text
+    QStringList terms;
+    const QStringList words = text.split(space, Qt::SkipEmptyParts);
+    for (QString word : words) {
+        word.remove('"');
+        if (!word.isEmpty()) {
+            terms << QString("%1 : \"%2\"*")
+                .arg(columns.at(static_cast<qint64>(scope)), word);
         }
-    } else {
-        qDebug() << "Error executing query:" << query.lastError().text();
     }
-    return list;
+
+    QVector<qint64> result;
+    ReadSlot slot(this);
+    QSqlQuery* query = getStatement(Statement::SearchLevels);
+    QueryTimer queryTimer("SearchLevels", query);
+    if ((query != nullptr) && !terms.isEmpty()) {
+        query->bindValue(":match", terms.join(" AND "));
+        if (query->exec() == true) {
+            while (query->next() == true) {
+                result.append(query->value(0).toLongLong());
+                queryTimer.addRow();
+            }
+        } else {
+            qDebug() << "Error executing query searchLevels:"
+                << query->lastError().text();
+        }
+        query->finish();
+    }
+    return result;
 }
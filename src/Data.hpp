@@ -14,9 +14,12 @@
 #ifndef SRC_DATA_HPP_
 #define SRC_DATA_HPP_
 
+#include <QBuffer>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QIcon>
+#include <QImageReader>
 #include <QObject>
 #include <QPainter>
 #include <QPixmap>
@@ -26,8 +29,17 @@
 #include <QSqlQuery>
 #include <QThread>
 #include <QMutex>
+#include <QSemaphore>
+
+#include <zstd.h>
+
+#include <atomic>
+#include <functional>
+#include <limits>
 
 #include "../src/assert.hpp"
+#include "../src/CoverAtlas.hpp"
+#include "../src/PicturePack.hpp"
 #include "Path.hpp"
 
 /**
@@ -40,6 +52,17 @@ struct FileListItem {
     QString md5sum;
 };
 
+/**
+ * @struct FileHashKey
+ * @brief A file on disk as it was when it was hashed.
+ */
+struct FileHashKey {
+    qint64 device;
+    qint64 inode;
+    qint64 size;
+    qint64 mtimeNs;
+};
+
 /**
  * @struct FolderNames
  * @brief Folder names game used on Windows.
@@ -327,6 +350,14 @@ struct ListItemData {
     void setPicture(const QPixmap& pixmap) {
         centerPixmap(pixmap);
     }
+
+    /**
+     * @brief Use a tile that is already scaled and centered.
+     * @param tile A CoverAtlas tile, no decoding or scaling is done.
+     */
+    void setCoverTile(const QImage& tile) {
+        m_cover = QPixmap::fromImage(tile);
+    }
     // Data members
     qint64 m_game_id;        ///< The Game id.
     qint64 m_trle_id;        ///< The TRLE level id.
@@ -376,45 +407,68 @@ struct ListItemData {
 
 /**
  * @struct InfoData
- * @brief Store HTML data and a list of level pictures generated from image WEBP data.
+ * @brief Store HTML data and a list of level pictures as WEBP data.
  *
- * This struct is designed to store a body of HTML and convert a list of image data 
- * (provided as `QByteArray`) into `QPixmap` objects. The `QPixmap` objects can then 
- * be used in Qt-based applications with QtWebEngine and QPixmap in a split view manner.
+ * This struct is designed to store a body of HTML and the undecoded level
+ * screenshots. The pictures are decoded with decodeImage() on a worker
+ * thread, so the body can be shown before any picture is ready.
  */
 struct InfoData {
     /**
      * @brief Default constructor for `InfoData`.
      *
-     * Initializes an empty body and an empty list of icons.
+     * Initializes an empty body and an empty list of images.
      */
     InfoData() {}
 
     /**
      * @brief Constructs an `InfoData` object with the given body and image list.
      *
-     * Converts each image in the provided `QVector<QByteArray>` to a `QPixmap` object
-     * using the "WEBP" format and stores them in the icon list.
-     *
      * @param body A string representing the main textual content in HTML.
      * @param imageList A vector of image data in `QByteArray` format.
      */
     InfoData(const QString& body, const QVector<QByteArray>& imageList)
-        : m_body(body) {
-        for (const QByteArray& image : imageList) {
-            QPixmap pixmap;
+        : m_body(body), m_imageData(imageList) {}
 
-            // Load image data into a QPixmap
-            if (!pixmap.loadFromData(image, "WEBP")) {
-                qDebug() << "Could not load webp data to QPixmap.";
+    /**
+     * @brief Decode a WEBP screenshot scaled to fit a size.
+     *
+     * Safe to call from any thread, it only uses QImage. The image is
+     * scaled by the decoder when the format supports it.
+     *
+     * @param imageData WEBP picture data.
+     * @param size Box to fit the image into, keeping the aspect ratio.
+     * @return The decoded image, null if the data could not be read.
+     */
+    static QImage decodeImage(const QByteArray& imageData, const QSize& size) {
+        QBuffer buffer;
+        buffer.setData(imageData);
+        buffer.open(QIODevice::ReadOnly);
+        QImageReader reader(&buffer, "WEBP");
+
+        QSize scaledSize = reader.size();
+        if (scaledSize.isValid()) {
+            scaledSize.scale(size, Qt::KeepAspectRatio);
+            if (reader.supportsOption(QImageIOHandler::ScaledSize)) {
+                reader.setScaledSize(scaledSize);
             }
+        }
 
-            m_imageList.push_back(pixmap);
+        QImage image = reader.read();
+        if (image.isNull()) {
+            qDebug() << "Could not decode webp data:" << reader.errorString();
+        } else {
+            if (scaledSize.isValid() && (image.size() != scaledSize)) {
+                image = image.scaled(scaledSize,
+                        Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            }
+            image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
         }
+        return image;
     }
 
     QString m_body;  ///< The textual content associated with this object.
-    QVector<QPixmap> m_imageList;  ///< A list of level large screen image data.
+    QVector<QByteArray> m_imageData;  ///< Level large screen WEBP data.
 };
 
 /**
@@ -430,6 +484,39 @@ class Data : public QObject {
     Q_OBJECT
 
  public:
+    /**
+     * @brief Compile-time keys for the prepared statement cache.
+     *
+     * The key is the index into the SQL text table in Data.cpp.
+     */
+    enum class Statement : quint8 {
+        ListRowCount = 0,
+        ListItems,
+        CoverMd5Batch,
+        CoverDataBatch,
+        Info,
+        Walkthrough,
+        Type,
+        Download,
+        SetDownloadMd5,
+        FileList,
+        SearchLevels,
+        LevelTextDictionary,
+        FileHashLookup,
+        FileHashStore,
+        PicturePackGeneration,
+        Count
+    };
+
+    /**
+     * @brief LevelSearch full-text columns a search is matched against.
+     */
+    enum class SearchScope : quint8 {
+        Title = 0,    ///< Level title.
+        Authors,      ///< Comma separated author names.
+        Description,  ///< Level body and walkthrough HTML.
+    };
+
     /**
      * Mayers thread safe singleton pattern.
      */
@@ -460,6 +547,29 @@ class Data : public QObject {
         } else {
             status = true;
         }
+
+        if (status == true) {
+            status = migrateDatabase();
+        }
+
+        if (status == true) {
+            // The cover cache lives next to the database
+            Path atlasPath(Path::resource);
+            atlasPath << "covers.atlas";
+            if (!m_coverAtlas.open(atlasPath.get())) {
+                qWarning() << "Covers will be decoded without the atlas";
+            }
+
+            // Pictures moved out of the database by -pk, if it was run,
+            // in the pack generation the offsets point into
+            const qint64 generation = getPicturePackGeneration();
+            Path packPath(Path::resource);
+            packPath << PicturePack::fileName(generation);
+            if (packPath.exists() &&
+                    !m_picturePack.open(packPath.get(), generation)) {
+                qWarning() << "Packed pictures can't be read";
+            }
+        }
         return status;
     }
 
@@ -470,13 +580,31 @@ class Data : public QObject {
     qint64 getListRowCount();
 
     /**
-     * @brief Get the main list of levels, without the picture
-     * @return The QVector ListItemData is all the level metadata
+     * @brief Get one page of the main list of levels, without the picture
+     *
+     * Pages are ordered newest release first. Pass the release date and
+     * trle.net lid of the last item of the previous page to get the next
+     * one, or m_listFirstRelease and m_listFirstId for the first page.
+     *
+     * @param release Release date of the last item already read.
+     * @param trleId trle.net lid of the last item already read.
+     * @param limit Max number of items in the page.
+     * @return The QVector ListItemData is level metadata, empty at the end
      */
-    QVector<QSharedPointer<ListItemData>> getListItems();
+    QVector<QSharedPointer<ListItemData>> getListPage(
+            const QString& release, const qint64 trleId, const qint64 limit);
+
+    static constexpr const char* m_listFirstRelease = "9999-12-31";
+    static constexpr qint64 m_listFirstId = std::numeric_limits<qint64>::max();
 
     /**
      * @brief Add Cover Pictures to ListItemData pointers
+     *
+     * The covers are fetched in batches with one `Info.trleID IN (...)`
+     * query per batch, rows are matched back to the items by trleID.
+     * Covers found in the CoverAtlas with the same Picture.md5sum are
+     * used as is, only the rest are decoded and added to the atlas.
+     *
      * @param Cache like used QVector for holding ListItemData pointers
      */
     void getCoverPictures(QVector<QSharedPointer<ListItemData>> items);
@@ -495,6 +623,18 @@ class Data : public QObject {
      */
     QString getWalkthrough(int id);
 
+    /**
+     * @brief Read a Level.body or Level.walkthrough column value.
+     *
+     * tombll_manage_data.py -z stores the HTML as zstd frames compressed
+     * with the shared dictionary in the Dictionary table. Those BLOBs are
+     * decompressed here, TEXT values are returned as they are.
+     *
+     * @param value Column value from the query.
+     * @return The HTML text, empty if the frame could not be decoded.
+     */
+    QString decodeLevelText(const QVariant& value);
+
     /**
      * @brief Get the type of a level
      * @param trle.net lid
@@ -523,34 +663,245 @@ class Data : public QObject {
      */
     void setDownloadMd5(const int id, const QString& newMd5sum);
 
+    /**
+     * @brief Look up the cached hashes of a file.
+     * @param key Device, inode, size and mtime of the file now.
+     * @param md5sum Set to the MD5 on a hit.
+     * @param blake2b Set to the BLAKE2b-256 on a hit.
+     * @return `true` if the file is unchanged since it was hashed.
+     */
+    bool getFileHash(const FileHashKey& key,
+            QString* md5sum, QString* blake2b);
+
+    /**
+     * @brief Cache the hashes of a file, on the writer thread.
+     * @param key Device, inode, size and mtime of the file before hashing.
+     */
+    void setFileHash(const FileHashKey& key,
+            const QString& md5sum, const QString& blake2b);
+
+    /**
+     * @brief Generation of the picture pack the PicturePack offsets are in.
+     * @return The generation, 0 before tombll_manage_data.py -pc ran.
+     */
+    qint64 getPicturePackGeneration();
+
+    /**
+     * @brief Ranked full-text search in the LevelSearch FTS5 index.
+     *
+     * Each word in the text is matched as a prefix and all words must match.
+     *
+     * @param text Search text as typed by the user.
+     * @param scope Columns to match.
+     * @return trle.net lids, best match first.
+     */
+    QVector<qint64> searchLevels(const QString& text, const SearchScope scope);
+
+    /**
+     * @brief Bring the user's copy of the database up to the latest schema.
+     *
+     * Reads the schema version from the singleton Version table and applies
+     * each newer migration in its own transaction. Every migration statement
+     * is idempotent, so a partly migrated database is safe to run again.
+     * Runs on the writer thread.
+     *
+     * @return `true` if the database is at the latest version.
+     */
+    bool migrateDatabase();
+
+    /**
+     * @brief Run a database write on the writer thread and wait for it.
+     *
+     * The writer thread owns the only read-write connection, in WAL mode so
+     * it doesn't block the readers. Every other thread reads on a read-only
+     * connection of its own.
+     *
+     * @param task Write to run, it uses getStatement() as usual.
+     */
+    void runOnWriter(const std::function<void()>& task);
+
+    /**
+     * @brief Run EXPLAIN QUERY PLAN on a cached statement.
+     *
+     * Placeholders are replaced by a literal so the plan matches what the
+     * planner picks for a bound value.
+     *
+     * @param key Statement key.
+     * @return The plan detail column, one string per plan step.
+     */
+    QStringList getQueryPlan(const Statement key);
+
+    /**
+     * @brief Number of times a cached prepared statement was reused.
+     */
+    quint64 getStatementCacheHits() const {
+        return m_statementHits.load();
+    }
+
+    /**
+     * @brief Number of times a statement had to be prepared.
+     */
+    quint64 getStatementCacheMisses() const {
+        return m_statementMisses.load();
+    }
+
+    /**
+     * @brief Number of times a read had to wait for a reader slot.
+     *
+     * Counts reads waiting for a free reader slot and writes queued
+     * behind another write.
+     */
+    quint64 getPoolWaitCount() const {
+        return m_poolWaits.load();
+    }
+
+    /**
+     * @brief Total time reads waited for a reader slot.
+     */
+    quint64 getPoolWaitNs() const {
+        return m_poolWaitNs.load();
+    }
+
  private:
-    Data() {}
-    ~Data() {}
+    Data();
+    ~Data();
 
-    QSqlDatabase& getThreadDatabase() {
-        static QMutex mutex;
-        const quintptr tid = (quintptr)QThread::currentThreadId();
-
-        QMutexLocker locker(&mutex);
-
-        if (!m_connectionTable.contains(tid)) {
-            const QString name = QString("conn_%1").arg(tid);
-            QSqlDatabase db;
-            if (QSqlDatabase::contains(name)) {
-                db = QSqlDatabase::database(name);
-            } else {
-                db = QSqlDatabase::addDatabase("QSQLITE", name);
-                db.setDatabaseName(m_path.get());
-                db.open();
-            }
-            m_connectionTable.insert(tid, db);
-        }
+    /**
+     * @struct Connection
+     * @brief A thread's database connection and its prepared statements.
+     */
+    struct Connection {
+        QString name;
+        QSqlDatabase db;
+        QVector<QSharedPointer<QSqlQuery>> statements;
+        bool writer = false;
+    };
+
+    /**
+     * @class ReadSlot
+     * @brief Holds one of the m_readerLimit reader slots while a read runs.
+     *
+     * A thread keeps its connection between reads but not a slot, so idle
+     * threads never keep others from reading. Nested reads share the slot
+     * of the outermost one, the writer thread takes none.
+     */
+    class ReadSlot {
+     public:
+        explicit ReadSlot(Data* data);
+        ~ReadSlot();
+
+     private:
+        Data* m_data;
+        bool m_held;
+
+        Q_DISABLE_COPY(ReadSlot)
+    };
+
+    /**
+     * @struct ThreadConnection
+     * @brief Thread local owner that closes the connection when the thread
+     * ends.
+     */
+    struct ThreadConnection {
+        Data* owner = nullptr;
+        QSharedPointer<Connection> connection;
+        ~ThreadConnection();
+    };
+
+    /**
+     * @brief Get a statement prepared on this thread's connection.
+     *
+     * The statement is prepared the first time it is used on a connection
+     * and reused after that, the caller binds new values and calls finish()
+     * when done reading so SQLite can release the read lock.
+     *
+     * @param key Statement key.
+     * @return The prepared query, or nullptr if it failed to prepare.
+     */
+    QSqlQuery* getStatement(const Statement key);
+
+    /**
+     * @brief The SQL text of a statement, with the batch placeholders.
+     */
+    QString getStatementSql(const Statement key) const;
+
+    /**
+     * @brief Bind a batch of trle.net lids to a cover batch statement.
+     *
+     * The statement has a fixed number of placeholders, unused ones are
+     * bound to NULL that never matches.
+     *
+     * @param query Cover batch statement.
+     * @param ids trle.net lids for the IN (...) list.
+     */
+    void bindCoverBatch(QSqlQuery* query, const QVector<qint64>& ids);
+
+    /**
+     * @brief Read a Picture from a row with data, offset and size columns.
+     *
+     * A packed Picture is a zero-copy span of the mapped pictures.pack,
+     * the rest are still BLOBs in the database.
+     *
+     * @param query Positioned on a row.
+     * @param column Picture.data column, followed by PicturePack.offset
+     *        and PicturePack.size.
+     * @return WEBP picture data.
+     */
+    QByteArray getPictureData(const QSqlQuery& query, const int column);
 
-        return m_connectionTable[tid];
+    /**
+     * @brief The level text dictionary, loaded on first use.
+     * @return Digested dictionary, nullptr if the database has none.
+     */
+    const ZSTD_DDict* getLevelTextDictionary();
+
+    /**
+     * @brief Index the text of compressed levels in LevelSearch.
+     *
+     * The LevelSearch triggers can't read compressed columns in SQL, this
+     * fills in the body and walkthrough of those rows after a migration.
+     *
+     * @return `true` if all rows were indexed.
+     */
+    bool indexLevelText();
+
+    /**
+     * @brief Get the calling thread's connection, opened on first use.
+     *
+     * The writer thread gets the read-write connection, other threads a
+     * read-only one. Reads are bounded by m_readerLimit through ReadSlot,
+     * not the connections.
+     */
+    Connection& getThreadConnection();
+
+    QSqlDatabase& getThreadDatabase() {
+        return getThreadConnection().db;
     }
 
+    QSharedPointer<Connection> openConnection(const bool writer);
+    void closeConnection(Connection* connection);
+
+    /**
+     * @brief Migrations and the post-migration passes, on the writer thread.
+     */
+    bool applyMigrations();
+
     Path m_path = Path(Path::resource);
-    QHash<quintptr, QSqlDatabase> m_connectionTable;
+    static constexpr int m_readerLimit = 8;  ///< Reads at the same time
+    QSemaphore m_readerSlots{m_readerLimit};
+    std::atomic<quint64> m_connectionSerial{0};
+    std::atomic<quint64> m_poolWaits{0};
+    std::atomic<quint64> m_poolWaitNs{0};
+    QThread m_writerThread;
+    QObject m_writerContext;  ///< Lives in m_writerThread, runs the writes
+    static constexpr qint64 m_coverBatchLimit = 64;  ///< Placeholders per batch
+    CoverAtlas m_coverAtlas;
+    PicturePack m_picturePack;
+    std::atomic<quint64> m_statementHits{0};
+    std::atomic<quint64> m_statementMisses{0};
+    QMutex m_levelTextDictMutex;
+    ZSTD_DDict* m_levelTextDict = nullptr;
+    bool m_levelTextDictLoaded = false;
     Q_DISABLE_COPY(Data)
 };
 
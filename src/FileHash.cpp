@@ -0,0 +1,96 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "../src/FileHash.hpp"
+#include <QDebug>
+#include <QFile>
+#include <sys/stat.h>
+
+FileHash::FileHash() :
+        data(Data::getInstance()),
+        m_hits(0),
+        m_misses(0) {
+}
+
+bool FileHash::statKey(const QString& path, FileHashKey* key) {
+    struct stat st;
+    key->size = -1;
+    if (stat(QFile::encodeName(path).constData(), &st) != 0) {
+        return false;
+    }
+    key->device = static_cast<qint64>(st.st_dev);
+    key->inode = static_cast<qint64>(st.st_ino);
+    key->size = static_cast<qint64>(st.st_size);
+    key->mtimeNs = static_cast<qint64>(st.st_mtim.tv_sec) * 1000000000 +
+        st.st_mtim.tv_nsec;
+    return true;
+}
+
+bool FileHash::lookup(const QString& path, FileHashKey* key, Sums* sums) {
+    bool status = statKey(path, key) &&
+        data.getFileHash(*key, &sums->md5, &sums->blake2b);
+    if (status == true) {
+        m_hits++;
+    } else {
+        m_misses++;
+    }
+    return status;
+}
+
+FileHash::Report::Report(const char* what) :
+        m_what(what),
+        m_hits(FileHash::getInstance().getHits()),
+        m_misses(FileHash::getInstance().getMisses()) {
+}
+
+FileHash::Report::~Report() {
+    const qint64 hits = FileHash::getInstance().getHits() - m_hits;
+    const qint64 misses = FileHash::getInstance().getMisses() - m_misses;
+    if ((hits + misses) > 0) {
+        qDebug() << "FileHash:" << m_what << "hit" << hits << "of"
+                 << (hits + misses) << "files";
+    }
+}
+
+void FileHash::store(const FileHashKey& key, const Sums& sums) {
+    if (key.size >= 0) {
+        data.setFileHash(key, sums.md5, sums.blake2b);
+    }
+}
+
+FileHash::Sums FileHash::get(const QString& path) {
+    FileHashKey key;
+    Sums sums;
+    if (lookup(path, &key, &sums) == true) {
+        return sums;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {  // flawfinder: ignore
+        qDebug() << "Error opening file for reading: " << file.errorString();
+        return sums;
+    }
+    Hasher hasher;
+    QByteArray buffer(1 << 20, Qt::Uninitialized);
+    qint64 size = 0;
+    while ((size = file.read(buffer.data(), buffer.size())) > 0) {
+        hasher.addData(QByteArrayView(buffer.constData(), size));
+    }
+    if (size == 0) {
+        sums = hasher.result();
+        store(key, sums);
+    } else {
+        qWarning() << "Failed to process file for hash:" << path;
+    }
+    return sums;
+}
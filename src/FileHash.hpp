@@ -0,0 +1,133 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef SRC_FILEHASH_HPP_
+#define SRC_FILEHASH_HPP_
+
+#include <QCryptographicHash>
+#include <QString>
+
+#include <atomic>
+
+#include "../src/Data.hpp"
+
+/**
+ * @class FileHash
+ * @brief MD5 and BLAKE2b of files on disk, cached in the FileHash table.
+ *
+ * A file is known by its device and inode. Its hashes stay valid while its
+ * size and nanosecond mtime are the same, so checking an unchanged file
+ * again costs one stat and one indexed lookup. Both hashes are made in the
+ * same pass over the file: MD5 is what the level database records, BLAKE2b
+ * is what the FileStore names its objects by.
+ */
+class FileHash {
+ public:
+    /**
+     * Mayers thread safe singleton pattern.
+     */
+    static FileHash& getInstance() {
+        // cppcheck-suppress threadsafety-threadsafety
+        static FileHash instance;
+        return instance;
+    }
+
+    /**
+     * @struct Sums
+     * @brief Hex encoded hashes of one file.
+     */
+    struct Sums {
+        QString md5;
+        QString blake2b;
+    };
+
+    /**
+     * @brief Hashes of a file, read from it only if it changed.
+     * @param path File to hash.
+     * @return The hashes, empty if the file can't be read.
+     */
+    Sums get(const QString& path);
+
+    /**
+     * @brief Cached hashes of a file, without reading it.
+     * @param path File to look up.
+     * @param key Set to the key of the file now, for store().
+     * @param sums Set to the cached hashes on a hit.
+     * @return `true` on a hit.
+     */
+    bool lookup(const QString& path, FileHashKey* key, Sums* sums);
+
+    /**
+     * @brief Cache hashes the caller made while reading the file.
+     * @param key Key from lookup(), taken before the file was read.
+     */
+    void store(const FileHashKey& key, const Sums& sums);
+
+    /**
+     * @brief Hashes both sums in one pass, feed it the file in order.
+     */
+    class Hasher {
+     public:
+        Hasher() :
+            m_md5(QCryptographicHash::Md5),
+            m_blake2b(QCryptographicHash::Blake2b_256) {}
+
+        void addData(QByteArrayView data) {
+            m_md5.addData(data);
+            m_blake2b.addData(data);
+        }
+
+        Sums result() const {
+            return {QString(m_md5.result().toHex()),
+                QString(m_blake2b.result().toHex())};
+        }
+
+     private:
+        QCryptographicHash m_md5;
+        QCryptographicHash m_blake2b;
+    };
+
+    /**
+     * @brief Logs the hit rate of the lookups made while it lives.
+     *
+     * One line for a whole batch instead of one per file. Lookups made by
+     * other threads at the same time are counted too.
+     */
+    class Report {
+     public:
+        explicit Report(const char* what);
+        ~Report();
+
+     private:
+        const char* m_what;
+        qint64 m_hits;
+        qint64 m_misses;
+
+        Q_DISABLE_COPY(Report)
+    };
+
+    qint64 getHits() const { return m_hits.load(); }
+    qint64 getMisses() const { return m_misses.load(); }
+
+ private:
+    FileHash();
+    static bool statKey(const QString& path, FileHashKey* key);
+
+    Data& data;
+    std::atomic<qint64> m_hits;
+    std::atomic<qint64> m_misses;
+
+    Q_DISABLE_COPY(FileHash)
+};
+
+#endif  // SRC_FILEHASH_HPP_
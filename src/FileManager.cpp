@@ -20,11 +20,14 @@
 #include <QByteArray>
 #include <QDataStream>
 #include <qlogging.h>
-#include "../miniz/miniz.h"  // IWYU pragma: keep
-#include "../miniz/miniz_zip.h"
+#include <algorithm>
 #include "../src/gameFileTreeData.hpp"
 #include "../src/binary.hpp"
+#include "../src/CopyEngine.hpp"
+#include "../src/FileHash.hpp"
 #include "../src/Path.hpp"
+#include "../src/Progress.hpp"
+#include "../src/ZipExtractor.hpp"
 
 bool FileManager::backupGameDir(Path path) {
     bool status = false;
@@ -48,20 +51,9 @@ const QString FileManager::calculateMD5(Path path) {
     if (path.exists() && !path.isFile()) {
         qDebug() << "Error: The path is not a regular file." << path.get();
     } else {
-        QFile file(path.get());
-        bool status = file.open(QIODevice::ReadOnly);  // flawfinder: ignore
-        if (!status) {
-            qDebug()
-                << "Error opening file for reading: " << file.errorString();
-        } else {
-            QCryptographicHash md5(QCryptographicHash::Md5);
-            if (!md5.addData(&file)) {
-                qWarning() << "Failed to process file for MD5 hash.";
-            } else {
-                result = QString(md5.result().toHex());
-            }
-            file.close();
-        }
+        // Only read if the file changed since it was last hashed
+        FileHash::Report report("calculateMD5");
+        result = FileHash::getInstance().get(path.get()).md5;
     }
     return result;
 }
@@ -121,8 +113,13 @@ int FileManager::copyFile(Path from, Path to) {
         status = 2;
     }
 
-    if ((status == 0) && (QFile::copy(from.get(), to.get()) == true)) {
-        qDebug() << "File copy to " << to.get() << " successfully.";
+    CopyEngine::Strategy strategy = CopyEngine::Strategy::Failed;
+    if (status == 0) {
+        strategy = CopyEngine::copy(from.get(), to.get());
+    }
+    if (strategy != CopyEngine::Strategy::Failed) {
+        qDebug() << "File copy to " << to.get() << " successfully with"
+                 << CopyEngine::strategyName(strategy);
     } else {
         qDebug() << "FileManager Failed to copy the file.";
         status = 3;
@@ -185,86 +182,46 @@ bool FileManager::extractZip(ZipData zipData) {
         QDir().mkpath(outputFolder.get());
     }
 
-    // Open the zip file
-    mz_zip_archive zip;
-    (void)memset(&zip, 0, sizeof(zip));
-    if (mz_zip_reader_init_file(
-        &zip, zipFilename.get().toUtf8().constData(), 0) == true) {
-        // Extract each file in the zip archive
-        quint64 numFiles = mz_zip_reader_get_num_files(&zip);
-        qDebug() << "Zip file contains" << numFiles << "files";
-
-        quint64 gotoPercent = 50;  // Percentage of total work
-        quint64 lastPrintedPercent = 0;  // Last printed percentage
-
-        for (quint64 i = 0; i < numFiles; i++) {
-            mz_zip_archive_file_stat file_stat;
-            if (!mz_zip_reader_file_stat(&zip, i, &file_stat)) {
-                qWarning() << "Failed to get file info for file" << i
-                           << "in zip file" << zipFilename.get();
-                mz_zip_reader_end(&zip);
-                fileWorkErrorSignal(2);
-                cleanWorkingDir(outputFolder);
-                break;
-            }
-
-            QString filePathName = QString::fromUtf8(file_stat.m_filename);
-            if (filePathName.endsWith('/') == true) {
-                continue;  // Skip directories
-            }
-
-            QString outFile = QString("%1%2%3").arg(outputFolder.get(), m_sep, filePathName);
-            qDebug() << "Extracting" << filePathName;
-
-            if (!QDir().mkpath(QFileInfo(outFile).path())) {
-                qWarning() << "Failed to create directory for file" << outFile;
-                mz_zip_reader_end(&zip);
-                fileWorkErrorSignal(3);
-                break;
-            }
-
-            if (!mz_zip_reader_extract_to_file(
-                    &zip,
-                    i,
-                    outFile.toUtf8().constData(),
-                    0)) {
-                qWarning() << "Failed to extract file" << filePathName
-                           << "from zip file" << zipFilename.get();
-                mz_zip_reader_end(&zip);
-                fileWorkErrorSignal(4);
-                break;
-            }
-
-            quint64 currentPercent =
-                ((i + quint64(1)) * gotoPercent) / numFiles;
+    ZipExtractor extractor;
+    int error = extractor.open(zipFilename.get());
+    if (error == 0) {
+        const int workers = std::clamp(QThread::idealThreadCount(), 1, 8);
+
+        QElapsedTimer timer;
+        timer.start();
+        error = extractor.extract(outputFolder.get(), workers,
+                [](quint64 done, quint64 total) {
+            Progress::getInstance().update(done, total);
+        });
+        qDebug() << "Extracted" << extractor.doneBytes() << "bytes with"
+                 << workers << "workers in" << timer.elapsed() << "ms";
+    }
 
-            if (currentPercent != lastPrintedPercent) {
-                for (quint64 j = lastPrintedPercent + quint64(1);
-                                j <= currentPercent; j++) {
-                    emit this->fileWorkTickSignal();
-                    QCoreApplication::processEvents();
-                }
-                lastPrintedPercent = currentPercent;
-                if (currentPercent == gotoPercent) {
-                    Path outputFolderExpectedExe = outputFolder;
-                    outputFolderExpectedExe << ExecutableNames().data[zipData.m_type];
-                    if (!outputFolderExpectedExe.isFile()) {
-                        linkToExe(outputFolder, zipData.m_type);
-                    }
-                    status = true;
-                    qDebug() << "Unzip complete";
-                }
-            }
-        }
+    if (error == 0) {
+        finishExtract(zipData);
+        status = true;
+        qDebug() << "Unzip complete";
     } else {
-        fileWorkErrorSignal(1);
-        qWarning() << "Failed to open zip file" << zipFilename.get();
+        if (error == 1) {
+            qWarning() << "Failed to open zip file" << zipFilename.get();
+        } else {
+            cleanWorkingDir(outputFolder);
+        }
+        emit fileWorkErrorSignal(error);
     }
-    // Clean up
-    mz_zip_reader_end(&zip);
     return status;
 }
 
+void FileManager::finishExtract(ZipData zipData) {
+    Path outputFolder = Path(Path::resource)
+                            << QString("%1.TRLE").arg(zipData.m_id);
+    Path outputFolderExpectedExe = outputFolder;
+    outputFolderExpectedExe << ExecutableNames().data[zipData.m_type];
+    if (!outputFolderExpectedExe.isFile()) {
+        linkToExe(outputFolder, zipData.m_type);
+    }
+}
+
 bool FileManager::getExtraPathToExe(Path &path, quint64 type) {
     bool status = false;
     qDebug() << "levelPath :" << path.get();
@@ -359,9 +316,12 @@ void FileManager::addLevelDir(Path& path, quint64 id) {
 
 QStringList FileManager::getSaveFiles(Path& path) {
     QStringList result;
-    QRegularExpression re("savegame\\.\\d+", QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression re("^savegame\\.\\d+$",
+        QRegularExpression::CaseInsensitiveOption);
 
-    QDirIterator it(path.get(), QDir::Files, QDirIterator::Subdirectories);
+    // The name filter skips most files before the regex sees them
+    QDirIterator it(path.get(), QStringList() << "savegame.*",
+        QDir::Files | QDir::NoSymLinks, QDirIterator::Subdirectories);
     while (it.hasNext()) {
         it.next();
         QFileInfo fi = it.fileInfo();
@@ -103,6 +103,7 @@ class FileManager : public QObject {
      * This function copies a file from either the game directory to the level directory
      * or vice versa, depending on the value of `fromGameDir`. It ensures that the
      * destination directory exists before attempting the copy operation.
+     * CopyEngine reflinks the file when the filesystem can.
      *
      * @param gameFile The relative path of the file in the game directory.
      * @param levelFile The relative path of the file in the level directory.
@@ -142,13 +143,23 @@ class FileManager : public QObject {
      * @param ZipData zip archive to extract.
      * @return `true` if extraction is successful, otherwise `false`.
      *
-     * @note This function uses `miniz` for ZIP operations.
+     * @note Entries are extracted in parallel by ZipExtractor, up to 8 workers.
      * @warning If extraction fails at any point, the function will attempt to clean up
      *          and terminate extraction, potentially leaving incomplete files.
-     * @signal fileWorkTickSignal() is emitted to indicate extraction progress.
+     * @note The uncompressed bytes written are published to Progress.
      */
     bool extractZip(ZipData zipData);
 
+    /**
+     * @brief Links the level executable once the archive has been extracted.
+     *
+     * Called by extractZip() and after a ZipStream extracted the archive
+     * while it was downloading.
+     *
+     * @param ZipData zip archive that was extracted.
+     */
+    void finishExtract(ZipData zipData);
+
     /**
      * @brief Determines an additional path to the executable within a level directory.
      *
@@ -205,7 +216,6 @@ class FileManager : public QObject {
     QStringList getSaveFiles(Path& path);
 
  signals:
-    void fileWorkTickSignal();
     void fileWorkErrorSignal(int status);
 
  private:
@@ -0,0 +1,170 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "../src/FileStore.hpp"
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include "../src/CopyEngine.hpp"
+#include "../src/FileHash.hpp"
+
+namespace {
+
+bool statPath(const QString& path, struct stat* st) {
+    return lstat(QFile::encodeName(path).constData(), st) == 0;
+}
+
+}  // namespace
+
+FileStore::FileStore(const QString& root) :
+        m_root(root) {
+}
+
+bool FileStore::storable(const QString& fileName) {
+    static const QSet<QString> suffixes = {
+        "exe", "dll", "wav", "mp3", "ogg", "tr2", "tr4", "trc", "phd",
+        "tom", "sfx", "pak", "dat", "bmp", "pcx", "jpg", "png", "rpl",
+        "bik", "avi", "mp4"
+    };
+    return suffixes.contains(QFileInfo(fileName).suffix().toLower());
+}
+
+QString FileStore::objectPath(const QString& hash) const {
+    return QString("%1/%2/%3").arg(m_root, hash.left(2), hash);
+}
+
+FileStore::Stats FileStore::addTree(const QString& dir) {
+    Stats stats;
+    FileHash::Report report("FileStore");
+    QDirIterator it(dir, QDir::Files | QDir::Hidden | QDir::NoSymLinks,
+        QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        struct stat st;
+        if (!storable(it.fileName()) || !statPath(path, &st) ||
+                !S_ISREG(st.st_mode) || (st.st_size < m_minSize) ||
+                (st.st_nlink > 1)) {
+            continue;  // Not stored or already linked
+        }
+
+        const QString hash = FileHash::getInstance().get(path).blake2b;
+        if (hash.isEmpty()) {
+            continue;
+        }
+        const QString object = objectPath(hash);
+        const QByteArray objectName = QFile::encodeName(object);
+        struct stat ost;
+        if (statPath(object, &ost) == true) {
+            if (ost.st_size != st.st_size) {
+                qWarning() << "FileStore: Size mismatch for" << object;
+                continue;
+            }
+            // Swap the file for a link to the object in one rename
+            const QByteArray temp = QFile::encodeName(path + ".trll-link");
+            if ((link(objectName.constData(), temp.constData()) == 0) &&
+                    (rename(temp.constData(),
+                        QFile::encodeName(path).constData()) == 0)) {
+                stats.files++;
+                stats.bytes += st.st_size;
+                stats.savedBytes += st.st_size;
+            } else {
+                (void)unlink(temp.constData());
+            }
+        } else if (QDir().mkpath(QFileInfo(object).path()) &&
+                (link(QFile::encodeName(path).constData(),
+                    objectName.constData()) == 0)) {
+            // The first copy becomes the object
+            (void)chmod(objectName.constData(), S_IRUSR | S_IRGRP | S_IROTH);
+            stats.bytes += st.st_size;
+        }
+    }
+    qDebug() << "FileStore: Linked" << stats.files << "files of" << dir
+             << "saving" << stats.savedBytes << "bytes";
+    return stats;
+}
+
+FileStore::Stats FileStore::collectGarbage() {
+    Stats stats;
+    QDirIterator it(m_root, QDir::Files | QDir::Hidden,
+        QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        struct stat st;
+        // Only the store links to it
+        if (statPath(path, &st) && (st.st_nlink == 1) &&
+                (unlink(QFile::encodeName(path).constData()) == 0)) {
+            stats.files++;
+            stats.bytes += st.st_size;
+        }
+    }
+    QDirIterator dirs(m_root, QDir::Dirs | QDir::NoDotAndDotDot);
+    while (dirs.hasNext()) {
+        (void)QDir(m_root).rmdir(QFileInfo(dirs.next()).fileName());
+    }
+    qDebug() << "FileStore: Removed" << stats.files << "unused objects,"
+             << stats.bytes << "bytes freed";
+    return stats;
+}
+
+FileStore::Stats FileStore::report() const {
+    Stats stats;
+    QDirIterator it(m_root, QDir::Files | QDir::Hidden,
+        QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        struct stat st;
+        if (statPath(it.next(), &st) == true) {
+            stats.files++;
+            stats.bytes += st.st_size;
+            // One link is the store, one would be there without it
+            if (st.st_nlink > 2) {
+                stats.savedBytes += st.st_size * (st.st_nlink - 2);
+            }
+        }
+    }
+    return stats;
+}
+
+bool FileStore::breakLink(const QString& path) {
+    struct stat st;
+    if (statPath(path, &st) == false) {
+        return false;
+    }
+    const QByteArray name = QFile::encodeName(path);
+    const mode_t mode = (st.st_mode & 07777) | S_IWUSR;
+    if (st.st_nlink <= 1) {
+        return chmod(name.constData(), mode) == 0;
+    }
+
+    // Copy out, a reflink where the filesystem can
+    const QString temp = path + ".trll-copy";
+    const QByteArray tempName = QFile::encodeName(temp);
+    (void)unlink(tempName.constData());
+    bool status = CopyEngine::copy(path, temp) != CopyEngine::Strategy::Failed;
+    if (status == true) {
+        status = (chmod(tempName.constData(), mode) == 0) &&
+            (rename(tempName.constData(), name.constData()) == 0);
+    }
+    if (status == true) {
+        qDebug() << "FileStore: Made a private copy of" << path;
+    } else {
+        qWarning() << "FileStore: Could not make a private copy of" << path;
+        (void)unlink(tempName.constData());
+    }
+    return status;
+}
@@ -0,0 +1,95 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef SRC_FILESTORE_HPP_
+#define SRC_FILESTORE_HPP_
+
+#include <QString>
+
+/**
+ * @class FileStore
+ * @brief Content addressed store that hardlinks identical level files.
+ *
+ * Installed levels carry the same tomb4.exe, DLLs, audio tracks and stock
+ * data files over and over. addTree() hashes each such file of a level
+ * directory with BLAKE2b, through the FileHash cache. The first copy of
+ * some content becomes the store object, linked in as
+ * <root>/<2 hex>/<hash>. Later copies are swapped for hardlinks to the
+ * object. Objects are read-only. A file that has to be
+ * changed in place gets a private copy first, see breakLink().
+ *
+ * Only file types the games never write are stored. Saves and config
+ * files stay private to their level.
+ */
+class FileStore {
+ public:
+    /**
+     * @struct Stats
+     * @brief Files and bytes counted by a store pass.
+     */
+    struct Stats {
+        qint64 files = 0;
+        quint64 bytes = 0;
+        quint64 savedBytes = 0;
+    };
+
+    /**
+     * @param root Store directory, on the same filesystem as the levels.
+     */
+    explicit FileStore(const QString& root);
+
+    /**
+     * @brief Move the storable files of a directory into the store.
+     * @param dir Level directory.
+     * @return Files swapped for links and the bytes that saved.
+     */
+    Stats addTree(const QString& dir);
+
+    /**
+     * @brief Remove objects no level links to anymore.
+     * @return Objects removed and the bytes freed.
+     */
+    Stats collectGarbage();
+
+    /**
+     * @brief Objects in the store, their bytes and the bytes the extra
+     *        links save.
+     */
+    Stats report() const;
+
+    /**
+     * @brief Give a file its own copy before it is written in place.
+     *
+     * Does nothing to a file that is not linked from the store but makes
+     * sure it is writable.
+     *
+     * @param path File about to be changed.
+     * @return `true` if the file can be written without touching the store.
+     */
+    static bool breakLink(const QString& path);
+
+    /**
+     * @brief File types that are never written by the games.
+     */
+    static bool storable(const QString& fileName);
+
+ private:
+    QString objectPath(const QString& hash) const;
+
+    /// Smaller files cost more in inodes and hashing than they save
+    static constexpr qint64 m_minSize = 4096;
+
+    QString m_root;
+};
+
+#endif  // SRC_FILESTORE_HPP_
@@ -0,0 +1,197 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "../src/HashCopy.hpp"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSet>
+#include <QThreadPool>
+#include <algorithm>
+#include <numeric>
+#include "../src/CopyEngine.hpp"
+#include "../src/FileHash.hpp"
+
+HashCopy::HashCopy() :
+        m_totalBytes(0),
+        m_doneBytes(0),
+        m_error(0),
+        m_reflinks(0) {
+}
+
+int HashCopy::run(const QVector<Job>& jobs, int workers,
+        const std::function<void(quint64, quint64)>& progress) {
+    m_totalBytes = 0;
+    m_doneBytes = 0;
+    m_error = 0;
+    m_reflinks = 0;
+    m_created.clear();
+    FileHash::Report report("HashCopy");
+
+    QVector<qint64> sizes(jobs.size());
+    QSet<QString> dirs;
+    for (qint64 i = 0; i < jobs.size(); i++) {
+        const QFileInfo from(jobs[i].from);
+        if (!from.isFile()) {
+            qWarning() << "HashCopy: Missing source file" << jobs[i].from;
+            return 1;
+        }
+        sizes[i] = from.size();
+        m_totalBytes += sizes[i];
+
+        // Make the directories up front so the workers never race on mkpath
+        const QString dir = QFileInfo(jobs[i].to).path();
+        if (!dirs.contains(dir)) {
+            if (!QDir().mkpath(dir)) {
+                qWarning() << "HashCopy: Failed to create directory" << dir;
+                return 3;
+            }
+            dirs.insert(dir);
+        }
+    }
+
+    // Largest file first to the worker with the fewest bytes so far
+    const qint64 count = std::clamp<qint64>(workers, 1,
+        std::max<qint64>(jobs.size(), 1));
+    QVector<qint64> order(jobs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sizes](qint64 a, qint64 b) {
+        return sizes[a] > sizes[b];
+    });
+    QVector<QVector<qint64>> buckets(count);
+    QVector<quint64> load(count, 0);
+    for (const qint64 i : order) {
+        const qint64 worker =
+            std::min_element(load.begin(), load.end()) - load.begin();
+        buckets[worker].append(i);
+        load[worker] += sizes[i] + 1;
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(count);
+    for (const QVector<qint64>& bucket : buckets) {
+        if (!bucket.isEmpty()) {
+            pool.start([this, &jobs, bucket]() {
+                runWorker(jobs, bucket);
+            });
+        }
+    }
+    while (!pool.waitForDone(50)) {
+        if (progress) {
+            progress(m_doneBytes.load(), m_totalBytes);
+        }
+    }
+
+    const int status = m_error.load();
+    if (status != 0) {
+        // Roll back, leave no copied file behind
+        for (const QString& path : m_created) {
+            (void)QFile::remove(path);
+        }
+        qWarning() << "HashCopy: Removed" << m_created.size()
+                   << "copied files after error" << status;
+    }
+    if (progress) {
+        progress(m_doneBytes.load(), m_totalBytes);
+    }
+    return status;
+}
+
+void HashCopy::runWorker(const QVector<Job>& jobs,
+        const QVector<qint64>& order) {
+    for (const qint64 i : order) {
+        if (m_error.load() != 0) {
+            break;
+        }
+        const int error = copyFile(jobs[i]);
+        if (error != 0) {
+            setError(error);
+            break;
+        }
+    }
+}
+
+int HashCopy::copyFile(const Job& job) {
+    QFile from(job.from);
+    if (!from.open(QIODevice::ReadOnly)) {  // flawfinder: ignore
+        qWarning() << "HashCopy: Could not read" << job.from
+                   << from.errorString();
+        return 1;
+    }
+    QFile to(job.to);
+    if (!to.open(QIODevice::WriteOnly | QIODevice::NewOnly)) {
+        qWarning() << "HashCopy: Could not create" << job.to
+                   << to.errorString();
+        return 3;
+    }
+    {
+        QMutexLocker locker(&m_createdMutex);
+        m_created.append(job.to);
+    }
+
+    // A reflinked file only has to be read for the hash
+    const bool cloned = CopyEngine::reflink(from.handle(), to.handle());
+    if (cloned == true) {
+        m_reflinks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // and not even that if the hash cache knows the file
+    FileHash& cache = FileHash::getInstance();
+    FileHashKey key;
+    FileHash::Sums sums;
+    const bool cached = cache.lookup(job.from, &key, &sums);
+    if (cloned && cached && (sums.md5 == job.md5sum)) {
+        (void)to.setPermissions(from.permissions());
+        m_doneBytes.fetch_add(key.size, std::memory_order_relaxed);
+        return 0;
+    }
+
+    FileHash::Hasher hasher;
+    QByteArray buffer(1 << 20, Qt::Uninitialized);
+    qint64 size = 0;
+    while ((size = from.read(buffer.data(), buffer.size())) > 0) {
+        if (m_error.load() != 0) {
+            return 0;  // Another worker failed, stop copying
+        }
+        hasher.addData(QByteArrayView(buffer.constData(), size));
+        if (!cloned && (to.write(buffer.constData(), size) != size)) {
+            qWarning() << "HashCopy: Could not write" << job.to
+                       << to.errorString();
+            return 3;
+        }
+        m_doneBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    if (size < 0) {
+        qWarning() << "HashCopy: Could not read" << job.from
+                   << from.errorString();
+        return 1;
+    }
+    (void)to.setPermissions(from.permissions());
+
+    sums = hasher.result();
+    cache.store(key, sums);
+    const QString calculated = sums.md5;
+    if (calculated != job.md5sum) {
+        qWarning() << "Original file was modified, had" << job.md5sum
+                   << "got" << calculated << "for file" << job.from;
+        return 2;
+    }
+    return 0;
+}
+
+void HashCopy::setError(int error) {
+    int expected = 0;
+    (void)m_error.compare_exchange_strong(expected, error);
+}
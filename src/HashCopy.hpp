@@ -0,0 +1,87 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef SRC_HASHCOPY_HPP_
+#define SRC_HASHCOPY_HPP_
+
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+
+/**
+ * @class HashCopy
+ * @brief Copies files while checking their MD5, reading each file once.
+ *
+ * Every buffer read from a source is hashed and written to its destination
+ * in the same pass. Where the filesystem can reflink the file the copy is
+ * a clone and the source is only read for the hash. The files are split
+ * over worker threads by size. The first missing source, hash mismatch or
+ * write error stops all workers and every destination file made so far is
+ * removed again.
+ */
+class HashCopy {
+ public:
+    /**
+     * @struct Job
+     * @brief One file to copy and the MD5 it must have.
+     */
+    struct Job {
+        QString from;
+        QString to;
+        QString md5sum;
+    };
+
+    HashCopy();
+
+    /**
+     * @brief Copy all files, blocking until done or failed.
+     *
+     * Calls the progress function on the calling thread while it waits
+     * and once more at the end.
+     *
+     * @param jobs Files to copy, destinations must not exist.
+     * @param workers Number of worker threads, at most one per file.
+     * @param progress Called with the bytes copied so far and totalBytes().
+     * @return int Status code:
+     *         - 0: All files copied and verified.
+     *         - 1: A source file could not be read.
+     *         - 2: A source file did not match its MD5.
+     *         - 3: A destination file could not be written.
+     */
+    int run(const QVector<Job>& jobs, int workers,
+            const std::function<void(quint64, quint64)>& progress = nullptr);
+
+    quint64 totalBytes() const { return m_totalBytes; }
+    quint64 doneBytes() const { return m_doneBytes.load(); }
+    qint64 reflinkCount() const { return m_reflinks.load(); }
+
+ private:
+    void runWorker(const QVector<Job>& jobs, const QVector<qint64>& order);
+    int copyFile(const Job& job);
+    void setError(int error);
+
+    quint64 m_totalBytes;
+    std::atomic<quint64> m_doneBytes;
+    std::atomic<int> m_error;
+    std::atomic<qint64> m_reflinks;
+    QStringList m_created;
+    QMutex m_createdMutex;
+
+    Q_DISABLE_COPY(HashCopy)
+};
+
+#endif  // SRC_HASHCOPY_HPP_
@@ -0,0 +1,291 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "../src/LevelCatalog.hpp"
+#include <QCollator>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <numeric>
+
+LevelCatalog::LevelCatalog() {
+    clear();
+}
+
+void LevelCatalog::clear() {
+    m_trleId.clear();
+    m_titleData.clear();
+    m_titleStart = {0};
+    m_authorRef.clear();
+    m_authorStart = {0};
+    m_authorName.clear();
+    m_authorIndex.clear();
+    m_releaseDay.clear();
+    m_type.clear();
+    m_class.clear();
+    m_difficulty.clear();
+    m_duration.clear();
+    m_installed.clear();
+    m_coverHandle.clear();
+    m_coverPool.clear();
+    for (QVector<QVector<quint64>>& bits : m_filterBits) {
+        bits.clear();
+    }
+    m_sortRank = QVector<QVector<quint32>>(
+        static_cast<qint64>(SortKey::Count));
+}
+
+quint32 LevelCatalog::internAuthor(const QString& name) {
+    auto it = m_authorIndex.constFind(name);
+    if (it != m_authorIndex.constEnd()) {
+        return it.value();
+    }
+    const quint32 index = m_authorName.size();
+    m_authorName.append(name);
+    m_authorIndex.insert(name, index);
+    return index;
+}
+
+void LevelCatalog::append(const QVector<QSharedPointer<ListItemData>>& items) {
+    const qint64 first = size();
+    const qint64 rows = first + items.size();
+    m_trleId.reserve(rows);
+    m_titleStart.reserve(rows + 1);
+    m_authorStart.reserve(rows + 1);
+    m_releaseDay.reserve(rows);
+    m_type.reserve(rows);
+    m_class.reserve(rows);
+    m_difficulty.reserve(rows);
+    m_duration.reserve(rows);
+    m_coverHandle.reserve(rows);
+    m_installed.resize((rows + 63) >> 6);
+
+    qint64 row = first;
+    for (const QSharedPointer<ListItemData>& item : items) {
+        m_trleId.append(static_cast<quint32>(item->m_trle_id));
+
+        m_titleData.append(item->m_title);
+        m_titleStart.append(m_titleData.size());
+
+        for (const QString& author : item->m_authors) {
+            m_authorRef.append(internAuthor(author));
+        }
+        m_authorStart.append(m_authorRef.size());
+
+        m_releaseDay.append(static_cast<qint32>(
+            QDate::fromString(item->m_releaseDate, Qt::ISODate).toJulianDay()));
+        m_type.append(static_cast<quint8>(item->m_type));
+        m_class.append(static_cast<quint8>(item->m_class));
+        m_difficulty.append(static_cast<quint8>(item->m_difficulty));
+        m_duration.append(static_cast<quint8>(item->m_duration));
+        setInstalled(row, item->m_installed);
+        m_coverHandle.append(-1);
+        row++;
+    }
+
+    for (QVector<quint32>& rank : m_sortRank) {
+        rank.clear();
+    }
+    for (QVector<QVector<quint64>>& bits : m_filterBits) {
+        bits.clear();
+    }
+}
+
+QString LevelCatalog::title(qint64 row) const {
+    const quint32 start = m_titleStart[row];
+    return m_titleData.mid(start, m_titleStart[row + 1] - start);
+}
+
+QStringList LevelCatalog::authors(qint64 row) const {
+    QStringList result;
+    const quint32 end = m_authorStart[row + 1];
+    for (quint32 i = m_authorStart[row]; i < end; i++) {
+        result << m_authorName.at(m_authorRef[i]);
+    }
+    return result;
+}
+
+QDate LevelCatalog::release(qint64 row) const {
+    return QDate::fromJulianDay(m_releaseDay[row]);
+}
+
+void LevelCatalog::setInstalled(qint64 row, bool installed) {
+    const quint64 bit = quint64(1) << (row & 63);
+    if (installed) {
+        m_installed[row >> 6] |= bit;
+    } else {
+        m_installed[row >> 6] &= ~bit;
+    }
+}
+
+void LevelCatalog::makeFilterBits() {
+    const QVector<quint8>* columns[4] = {
+        &m_class, &m_type, &m_difficulty, &m_duration
+    };
+    for (int c = 0; c < 4; c++) {
+        QVector<QVector<quint64>>& bits = m_filterBits[c];
+        bits.clear();
+        const QVector<quint8>& column = *columns[c];
+        for (qint64 row = 0; row < size(); row++) {
+            const quint8 value = column[row];
+            if (value >= bits.size()) {
+                bits.resize(value + 1);
+            }
+            if (bits[value].isEmpty()) {
+                bits[value].resize(words());
+            }
+            bits[value][row >> 6] |= quint64(1) << (row & 63);
+        }
+    }
+}
+
+QVector<quint64> LevelCatalog::filter(const Filter& filter) {
+    if ((size() != 0) && m_filterBits[0].isEmpty()) {
+        makeFilterBits();
+    }
+
+    // Start with every row, the unused bits of the last word stay clear
+    QVector<quint64> result(words(), ~quint64(0));
+    if ((size() & 63) != 0) {
+        result.last() = (quint64(1) << (size() & 63)) - 1;
+    }
+
+    const quint8 values[4] = {
+        filter.levelClass, filter.type, filter.difficulty, filter.duration
+    };
+    for (int c = 0; c < 4; c++) {
+        if (values[c] != 0) {
+            const QVector<QVector<quint64>>& bits = m_filterBits[c];
+            if ((values[c] < bits.size()) && !bits[values[c]].isEmpty()) {
+                const quint64* mask = bits[values[c]].constData();
+                quint64* out = result.data();
+                for (qint64 i = 0; i < result.size(); i++) {
+                    out[i] &= mask[i];
+                }
+            } else {
+                result.fill(0);
+            }
+        }
+    }
+
+    if (filter.installed == true) {
+        const quint64* mask = m_installed.constData();
+        quint64* out = result.data();
+        for (qint64 i = 0; i < result.size(); i++) {
+            out[i] &= mask[i];
+        }
+    }
+    return result;
+}
+
+QVector<quint64> LevelCatalog::rowsOf(const QSet<quint64>& lids) const {
+    QVector<quint64> result(words(), 0);
+    for (qint64 row = 0; row < size(); row++) {
+        if (lids.contains(m_trleId[row])) {
+            result[row >> 6] |= quint64(1) << (row & 63);
+        }
+    }
+    return result;
+}
+
+QPixmap LevelCatalog::cover(qint64 row) const {
+    const qint32 handle = m_coverHandle[row];
+    return handle >= 0 ? m_coverPool.at(handle) : QPixmap();
+}
+
+void LevelCatalog::setCover(qint64 row, const QPixmap& cover) {
+    qint32& handle = m_coverHandle[row];
+    if (handle < 0) {
+        handle = m_coverPool.size();
+        m_coverPool.append(cover);
+    } else {
+        m_coverPool[handle] = cover;
+    }
+}
+
+const QVector<quint32>& LevelCatalog::sortRank(SortKey key) {
+    QVector<quint32>& rank = m_sortRank[static_cast<qint64>(key)];
+    if (rank.size() != size()) {
+        rank = makeSortRank(key);
+    }
+    return rank;
+}
+
+QVector<quint32> LevelCatalog::makeSortRank(SortKey key) const {
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 rows = size();
+    QVector<quint32> order(rows);
+    std::iota(order.begin(), order.end(), 0);
+
+    if (key == SortKey::Title) {
+        QCollator collator;
+        collator.setCaseSensitivity(Qt::CaseInsensitive);
+        collator.setNumericMode(true);
+        QVector<QCollatorSortKey> titleKey;
+        titleKey.reserve(rows);
+        for (qint64 row = 0; row < rows; row++) {
+            titleKey.append(collator.sortKey(title(row)));
+        }
+        std::stable_sort(order.begin(), order.end(),
+                [&titleKey](quint32 a, quint32 b) {
+            return titleKey[a].compare(titleKey[b]) < 0;
+        });
+    } else {
+        // Integer key column, release dates are already day numbers
+        QVector<qint32> column(rows);
+        for (qint64 row = 0; row < rows; row++) {
+            switch (key) {
+            case SortKey::Difficulty: column[row] = m_difficulty[row]; break;
+            case SortKey::Duration:   column[row] = m_duration[row];   break;
+            case SortKey::Class:      column[row] = m_class[row];      break;
+            case SortKey::Type:       column[row] = m_type[row];       break;
+            default:                  column[row] = m_releaseDay[row]; break;
+            }
+        }
+        std::stable_sort(order.begin(), order.end(),
+                [&column](quint32 a, quint32 b) {
+            return column[a] < column[b];
+        });
+    }
+
+    QVector<quint32> rank(rows);
+    for (qint64 i = 0; i < rows; i++) {
+        rank[order[i]] = i;
+    }
+    qDebug() << "LevelCatalog sort key" << static_cast<int>(key)
+             << "for" << rows << "levels in" << timer.elapsed() << "ms";
+    return rank;
+}
+
+qint64 LevelCatalog::bytes() const {
+    qint64 result = 0;
+    result += m_trleId.capacity() * sizeof(quint32);
+    result += m_titleData.capacity() * sizeof(QChar);
+    result += m_titleStart.capacity() * sizeof(quint32);
+    result += m_authorRef.capacity() * sizeof(quint32);
+    result += m_authorStart.capacity() * sizeof(quint32);
+    result += m_authorName.capacity() * sizeof(QString);
+    for (const QString& name : m_authorName) {
+        // The hash key shares the string data with m_authorName
+        result += name.capacity() * sizeof(QChar);
+    }
+    result += m_authorIndex.capacity() *
+        (sizeof(QString) + sizeof(quint32) + sizeof(void*));
+    result += m_releaseDay.capacity() * sizeof(qint32);
+    result += m_type.capacity() + m_class.capacity();
+    result += m_difficulty.capacity() + m_duration.capacity();
+    result += m_installed.capacity() * sizeof(quint64);
+    result += m_coverHandle.capacity() * sizeof(qint32);
+    result += m_coverPool.capacity() * sizeof(QPixmap);
+    return result;
+}
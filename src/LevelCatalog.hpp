@@ -0,0 +1,167 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef SRC_LEVELCATALOG_HPP_
+#define SRC_LEVELCATALOG_HPP_
+
+#include <QDate>
+#include <QHash>
+#include <QPixmap>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "../src/Data.hpp"
+
+/**
+ * @class LevelCatalog
+ * @brief Struct-of-arrays store of the level cards shown in the level list.
+ *
+ * Every column is a packed array indexed by row. Titles share one string
+ * buffer, author names are interned once, release dates are Julian day
+ * numbers and covers are handles into a pixmap pool, so a row without a
+ * cover costs a few dozen bytes. Filters and sorting can read a single
+ * column without touching the others.
+ */
+class LevelCatalog {
+ public:
+    LevelCatalog();
+
+    /**
+     * @brief Columns the level list can be sorted by.
+     */
+    enum class SortKey : quint8 {
+        Title = 0,
+        Difficulty,
+        Duration,
+        Class,
+        Type,
+        Release,
+        Count
+    };
+
+    /**
+     * @brief Level list filter, a zero id matches any value.
+     */
+    struct Filter {
+        quint8 levelClass = 0;
+        quint8 type = 0;
+        quint8 difficulty = 0;
+        quint8 duration = 0;
+        bool installed = false;  ///< Only installed levels
+    };
+
+    /**
+     * @brief Drop all rows, interned authors and covers.
+     */
+    void clear();
+
+    /**
+     * @brief Append level records, as read by Data::getListPage().
+     * @param items Level metadata, the cover pixmaps are not copied.
+     */
+    void append(const QVector<QSharedPointer<ListItemData>>& items);
+
+    qint64 size() const { return m_trleId.size(); }
+
+    quint32 trleId(qint64 row) const { return m_trleId[row]; }
+    QString title(qint64 row) const;
+    QStringList authors(qint64 row) const;
+    qint32 releaseDay(qint64 row) const { return m_releaseDay[row]; }
+    QDate release(qint64 row) const;
+    quint8 type(qint64 row) const { return m_type[row]; }
+    quint8 levelClass(qint64 row) const { return m_class[row]; }
+    quint8 difficulty(qint64 row) const { return m_difficulty[row]; }
+    quint8 duration(qint64 row) const { return m_duration[row]; }
+
+    bool installed(qint64 row) const {
+        return (m_installed[row >> 6] >> (row & 63)) & 1;
+    }
+    void setInstalled(qint64 row, bool installed);
+
+    bool hasCover(qint64 row) const { return m_coverHandle[row] >= 0; }
+    QPixmap cover(qint64 row) const;
+    void setCover(qint64 row, const QPixmap& cover);
+
+    /**
+     * @brief Ascending sort position of every row for a sort key.
+     *
+     * The ranks are computed once per key, by sorting a permutation of the
+     * rows on a precomputed key column, and kept until rows are added.
+     * Ties keep the catalog order, newest release first.
+     *
+     * @param key Column to sort by.
+     * @return Rank per row, comparing two ranks compares the two rows.
+     */
+    const QVector<quint32>& sortRank(SortKey key);
+
+    /**
+     * @brief Rows that pass a filter, as a bitset of 64 bit words.
+     *
+     * One bitset per class, type, difficulty and duration value is built
+     * once from the catalog, a filter is the AND of those and the
+     * installed bits, no row is looked at.
+     *
+     * @param filter Ids to match.
+     * @return Bit row%64 of word row/64 is set for every matching row.
+     */
+    QVector<quint64> filter(const Filter& filter);
+
+    /**
+     * @brief Rows of a set of trle.net lids, as a bitset of 64 bit words.
+     * @param lids trle.net lids, like a search result.
+     * @return Bit row%64 of word row/64 is set for every row in lids.
+     */
+    QVector<quint64> rowsOf(const QSet<quint64>& lids) const;
+
+    static bool testRow(const QVector<quint64>& bits, qint64 row) {
+        return (bits[row >> 6] >> (row & 63)) & 1;
+    }
+
+    /**
+     * @brief Heap bytes held by the columns, from the container capacities.
+     * @return Approximate memory used by the catalog, covers not included.
+     */
+    qint64 bytes() const;
+
+ private:
+    quint32 internAuthor(const QString& name);
+    QVector<quint32> makeSortRank(SortKey key) const;
+    void makeFilterBits();
+    qint64 words() const { return (size() + 63) >> 6; }
+
+    QVector<quint32> m_trleId;
+    QString m_titleData;             ///< All titles back to back
+    QVector<quint32> m_titleStart;   ///< size()+1 offsets into m_titleData
+    QVector<quint32> m_authorRef;    ///< Indexes into m_authorName
+    QVector<quint32> m_authorStart;  ///< size()+1 offsets into m_authorRef
+    QStringList m_authorName;
+    QHash<QString, quint32> m_authorIndex;
+    QVector<qint32> m_releaseDay;
+    QVector<quint8> m_type;
+    QVector<quint8> m_class;
+    QVector<quint8> m_difficulty;
+    QVector<quint8> m_duration;
+    QVector<quint64> m_installed;    ///< One bit per row
+    QVector<qint32> m_coverHandle;   ///< Index into m_coverPool, -1 if none
+    QVector<QPixmap> m_coverPool;
+    /// Cached sortRank() per SortKey, empty until asked for
+    QVector<QVector<quint32>> m_sortRank;
+    /// Bitset per id value of class, type, difficulty and duration,
+    /// empty until filter() is asked for
+    QVector<QVector<quint64>> m_filterBits[4];
+};
+
+#endif  // SRC_LEVELCATALOG_HPP_
@@ -0,0 +1,71 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "../src/LevelDetailCache.hpp"
+#include <QMutexLocker>
+
+LevelDetailCache::LevelDetailCache(qint64 maxBytes) :
+        m_cache(maxBytes / 1024) {
+}
+
+qint64 LevelDetailCache::cost(const LevelDetail& detail) {
+    qint64 bytes = (detail.info.m_body.size() + detail.walkthrough.size()) *
+        sizeof(QChar);
+    for (const QByteArray& image : detail.info.m_imageData) {
+        bytes += image.size();
+    }
+    for (const QImage& screen : detail.screens) {
+        bytes += screen.sizeInBytes();
+    }
+    return qMax(qint64(1), bytes / 1024);
+}
+
+bool LevelDetailCache::lookup(qint64 id, LevelDetail* detail) {
+    const bool hit = peek(id, detail);
+    if (hit) {
+        m_hits++;
+    } else {
+        m_misses++;
+    }
+    return hit;
+}
+
+bool LevelDetailCache::peek(qint64 id, LevelDetail* detail) {
+    QMutexLocker locker(&m_mutex);
+    // object() also moves the entry to the front of the LRU list
+    const LevelDetail* entry = m_cache.object(id);
+    if (entry != nullptr) {
+        *detail = *entry;
+    }
+    return entry != nullptr;
+}
+
+void LevelDetailCache::insert(qint64 id, const LevelDetail& detail) {
+    QMutexLocker locker(&m_mutex);
+    m_cache.insert(id, new LevelDetail(detail), cost(detail));
+}
+
+void LevelDetailCache::setScreens(qint64 id, const QVector<QImage>& screens) {
+    QMutexLocker locker(&m_mutex);
+    const LevelDetail* entry = m_cache.object(id);
+    if (entry != nullptr) {
+        LevelDetail* detail = new LevelDetail(*entry);
+        detail->screens = screens;
+        m_cache.insert(id, detail, cost(*detail));
+    }
+}
+
+void LevelDetailCache::remove(qint64 id) {
+    QMutexLocker locker(&m_mutex);
+    m_cache.remove(id);
+}
@@ -0,0 +1,88 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef SRC_LEVELDETAILCACHE_HPP_
+#define SRC_LEVELDETAILCACHE_HPP_
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+#include "../src/Data.hpp"
+
+/**
+ * @struct LevelDetail
+ * @brief Everything the Info and Walkthrough pages show for one level.
+ */
+struct LevelDetail {
+    InfoData info;            ///< Body HTML and the WEBP screenshots.
+    QString walkthrough;      ///< Walkthrough HTML, empty if there is none.
+    QVector<QImage> screens;  ///< Decoded screenshots, empty until decoded.
+
+    bool hasWalkthrough() const { return !walkthrough.isEmpty(); }
+    bool hasScreens() const {
+        return screens.size() == info.m_imageData.size();
+    }
+};
+
+/**
+ * @class LevelDetailCache
+ * @brief Bounded LRU cache of LevelDetail keyed by trle.net lid.
+ *
+ * Shared by the reader pool and the prefetch thread, every call locks.
+ * The bound is on the approximate bytes held by the entries.
+ */
+class LevelDetailCache {
+ public:
+    explicit LevelDetailCache(qint64 maxBytes);
+
+    /**
+     * @brief Copy out a cached level, counts as a hit or a miss.
+     * @param id trle.net lid.
+     * @param detail Receives the level on a hit.
+     * @return `true` on a hit.
+     */
+    bool lookup(qint64 id, LevelDetail* detail);
+
+    /**
+     * @brief Like lookup() but not counted, for the prefetcher.
+     */
+    bool peek(qint64 id, LevelDetail* detail);
+
+    void insert(qint64 id, const LevelDetail& detail);
+
+    /**
+     * @brief Add the decoded screenshots to a cached level.
+     */
+    void setScreens(qint64 id, const QVector<QImage>& screens);
+
+    void remove(qint64 id);
+
+    quint64 hits() const { return m_hits; }
+    quint64 misses() const { return m_misses; }
+
+ private:
+    static qint64 cost(const LevelDetail& detail);
+
+    QMutex m_mutex;
+    QCache<qint64, LevelDetail> m_cache;  ///< Cost in KiB
+    std::atomic<quint64> m_hits{0};
+    std::atomic<quint64> m_misses{0};
+
+    Q_DISABLE_COPY(LevelDetailCache)
+};
+
+#endif  // SRC_LEVELDETAILCACHE_HPP_
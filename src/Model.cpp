@@ -13,10 +13,17 @@
 
 #include "../src/Model.hpp"
 #include "../src/Data.hpp"
+#include "../src/FileStore.hpp"
+#include "../src/HashCopy.hpp"
 #include "../src/Path.hpp"
+#include "../src/Progress.hpp"
+#include "../src/SaveStore.hpp"
+#include "../src/TrashReaper.hpp"
+#include "../src/ZipStream.hpp"
 #include "../src/assert.hpp"
 #include <QtGlobal>
 #include <qlogging.h>
+#include <algorithm>
 
 Model::Model() :
         data(Data::getInstance()),
@@ -36,6 +43,11 @@ void Model::setup() {
     Path::setResourcePath();
     #endif
     if(data.initializeDatabase()) {
+        // Deletes in the background, first what the last run left
+        Path trashPath(Path::resource);
+        trashPath << ".trash";
+        TrashReaper::getInstance().start(trashPath.get(), storePath());
+
         QList<int> commonFiles;
         checkCommonFiles(&commonFiles);
         // Iterate backward to avoid index shifting
@@ -55,7 +67,6 @@ void Model::setup() {
             }
         }
         emit generateListSignal(commonFiles);
-        QCoreApplication::processEvents();
     } else {
         qCritical() << "Initializing database failed!";
     }
@@ -110,8 +121,16 @@ int Model::checkGameDirectory(int id) {
     return status;
 }
 
-void Model::getList(QVector<QSharedPointer<ListItemData>>* list) {
-    *list = data.getListItems();
+bool Model::getListPage(QString* release, qint64* trleId) {
+    QVector<QSharedPointer<ListItemData>> page =
+            data.getListPage(*release, *trleId, m_listPageSize);
+    const bool last = page.size() < m_listPageSize;
+    if (!page.isEmpty()) {
+        *release = page.last()->m_releaseDate;
+        *trleId = page.last()->m_trle_id;
+    }
+    emit modelListPageSignal(page, last);
+    return last;
 }
 
 void Model::getCoverList(QVector<QSharedPointer<ListItemData>> items) {
@@ -154,7 +173,7 @@ void Model::run(RunnerOptions options) {
     // Command specific
     if ((options.command == UMU) || (options.command ==  WINE)) {
         // Path the executable directory
-        fileManager.getExtraPathToExe(path, data.getType(options.id));
+        fileManager.getExtraPathToExe(path, options.type);
 
         // Shell arguments
         for (QPair<QString, QString>& env : options.envList) {
@@ -167,16 +186,15 @@ void Model::run(RunnerOptions options) {
         }
 
         // Executable to run
-        const quint64 type = getType(options.id);
-        m_runner.addArguments(QStringList() << ExecutableNames().data[type]);
+        m_runner.addArguments(
+            QStringList() << ExecutableNames().data[options.type]);
         if (options.setup) {
             m_runner.addArguments(QStringList() << "-setup");
         }
     } else if (options.command == LUTRIS) {
         m_runner.addArguments(options.arguments);
     } else if (options.command == STEAM) {
-        const quint64 type = getType(options.id);
-        const quint64 steamID = SteamAppIds().data[type];
+        const quint64 steamID = SteamAppIds().data[options.type];
         const QString arument = QString("steam://run/%1").arg(steamID);
         m_runner.addArguments(QStringList() << arument);
     } else if (options.command == BASH) {
@@ -223,47 +241,43 @@ void Model::setupGame(int id) {
     from << getPrograFilesDirectory(id);
     to << QString("Original.TR%1").arg(id);
 
-    quint64 lastPrintedPercent = 0;
-    for (size_t i = 0; i < s; i++) {
+    QVector<HashCopy::Job> jobs;
+    jobs.reserve(s);
+    for (const FileListItem& item : list) {
         Path fromFile = from;
-        fromFile << list[i].path;
+        fromFile << item.path;
         Path toFile = to;
-        toFile << list[i].path;
-
-        const QString calculated = fileManager.calculateMD5(fromFile);
-
-        if (list[i].md5sum == calculated) {
-            (void)fileManager.copyFile(fromFile, toFile);
-
-            qint64 percent = (i * 100) / s;
-            if (percent != lastPrintedPercent) {
-                int delta = percent - lastPrintedPercent;
-                for (int j=0; j < delta; j++) {
-                    emit this->modelTickSignal();
-                    QCoreApplication::processEvents();
-                }
-                lastPrintedPercent = percent;
-            }
-        } else {
-            qDebug() << "Original file was modified, had" << list[i].md5sum
-                     << " got " << calculated << " for file "
-                     << list[i].path << Qt::endl;
-            (void)fileManager.cleanWorkingDir(to);
-            break;
-        }
+        toFile << item.path;
+        jobs.append({fromFile.get(), toFile.get(), item.md5sum});
     }
 
-    if (fileManager.backupGameDir(from)) {
-        if (!fileManager.linkPaths(to, from)) {
-            qDebug() << "Faild to create the link to the new game directory";
+    // Each file is read once, hashed while it's copied
+    Progress& progress = Progress::getInstance();
+    progress.begin(Progress::Phase::Copy, 0, 1000);
+    HashCopy copier;
+    const int error = copier.run(jobs,
+            std::clamp(QThread::idealThreadCount(), 1, 8),
+            [&progress](quint64 done, quint64 total) {
+        progress.update(done, total);
+    });
+
+    if (error == 0) {
+        qDebug() << "Copied" << copier.doneBytes() << "bytes of"
+                 << jobs.size() << "original files,"
+                 << copier.reflinkCount() << "as reflinks";
+        if (fileManager.backupGameDir(from)) {
+            if (!fileManager.linkPaths(to, from)) {
+                qDebug() << "Faild to create the link to the new game directory";
+            }
         }
+    } else {
+        (void)fileManager.cleanWorkingDir(to);
     }
 
-    if (lastPrintedPercent < 100) {
-        for (int i = lastPrintedPercent; i < 100; i++) {
-            emit this->modelTickSignal();
-            QCoreApplication::processEvents();
-        }
+    if (error == 0) {
+        progress.finish();
+    } else {
+        progress.fail();
     }
 }
 
@@ -284,7 +298,8 @@ bool Model::deleteZip(int id) {
     Path path(Path::resource);
     path << zipData.m_fileName;
     if (path.isFile()) {
-        status = fileManager.removeFileOrDirectory(path);
+        status = TrashReaper::getInstance().trash(path.get()) ||
+            (fileManager.removeFileOrDirectory(path) == 0);
     }
     return status;
 }
@@ -297,11 +312,20 @@ bool Model::deleteLevel(int id) {
         Path testPath = Path(Path::resource);
         Q_ASSERT_WITH_TRACE(path.get() != testPath.get());
 
-        quint64 error = fileManager.removeFileOrDirectory(path);
-        if (error == 0) {
+        // One rename, the reaper thread unlinks the files
+        const bool trashed = TrashReaper::getInstance().trash(path.get());
+        if ((trashed == true) ||
+                (fileManager.removeFileOrDirectory(path) == 0)) {
             status = true;
         }
 
+        // Drop store objects only this level linked to, for trash the
+        // reaper does it once the files are gone
+        if ((status == true) && (trashed == false) &&
+                QFileInfo(storePath()).isDir()) {
+            (void)FileStore(storePath()).collectGarbage();
+        }
+
         if (id<0) {
             g_settings.setValue(
                     QString("installed/game%1").arg(-id),
@@ -316,14 +340,58 @@ bool Model::deleteLevel(int id) {
     return status;
 }
 
+QString Model::storePath() {
+    Path path(Path::resource);
+    path << ".store";
+    return path.get();
+}
+
 bool Model::backupSaveFiles(int id) {
-    bool status = false;
     Path path = Path(Path::resource);
     fileManager.addLevelDir(path, id);
+    if (!path.isDir()) {
+        return false;
+    }
     QStringList list = fileManager.getSaveFiles(path);
+    SaveStore store(savesPath(id), path.get());
+    const int error = store.snapshot(list);
+    if (error == 0) {
+        pruneSaves(&store);
+    }
+    return error <= 1;
+}
+
+void Model::pruneSaves(SaveStore* store) {
+    (void)store->prune(
+        g_settings.value("SaveSnapshotsKeep", 20).toLongLong(),
+        g_settings.value("SaveSnapshotsKeepDays", 7).toLongLong());
+}
+
+QVector<qint64> Model::getSaveSnapshots(int id) {
+    Path path = Path(Path::resource);
+    fileManager.addLevelDir(path, id);
+    return SaveStore(savesPath(id), path.get()).list();
+}
+
+bool Model::restoreSaveSnapshot(int id, qint64 snapshot) {
+    Path path = Path(Path::resource);
+    fileManager.addLevelDir(path, id);
+    SaveStore store(savesPath(id), path.get());
+    // Prune after the restore, the snapshot of the saves it replaces
+    // could push the one asked for out of retention
+    const bool status =
+        store.restore(snapshot, fileManager.getSaveFiles(path));
+    pruneSaves(&store);
     return status;
 }
 
+QString Model::savesPath(int id) {
+    Path path(Path::resource);
+    path << ".saves";
+    fileManager.addLevelDir(path, id);
+    return path.get();
+}
+
 void Model::updateLevel(const int id) {
     qint64 status = m_pyRunner.updateLevel(id);
     emit this->modelLoadingDoneSignal();
@@ -342,19 +410,13 @@ bool Model::getLevelHaveFile(
         if (existingFilesum != md5sum) {
             downloader.run();
             if (downloader.getStatus() == 0) {
-                const QString downloadedSum =
-                    fileManager.calculateMD5(path);
+                const QString downloadedSum = downloader.getMd5();
                 if (downloadedSum != md5sum) {
                     data.setDownloadMd5(id, downloadedSum);
                 }
                 status = true;
             }
         } else {
-            // send 50% signal for skipped downloading ticks
-            for (int i=0; i < 50; i++) {
-                emit this->modelTickSignal();
-                QCoreApplication::processEvents();
-            }
             status = true;
         }
     }
@@ -366,7 +428,7 @@ bool Model::getLevelDontHaveFile(
     bool status = false;
     downloader.run();
     if (downloader.getStatus() == 0) {
-        const QString downloadedSum = fileManager.calculateMD5(path);
+        const QString downloadedSum = downloader.getMd5();
         if (downloadedSum != md5sum) {
             data.setDownloadMd5(id, downloadedSum);
         }
@@ -384,8 +446,13 @@ void Model::getLevel(int id) {
         path << zipData.m_fileName;
         downloader.setUrl(zipData.m_URL);
         downloader.setSaveFile(path);
-        // this if just slips up execution but has nothing to do with the error
-
+        // Extract the archive while it downloads
+        Path levelPath(Path::resource);
+        fileManager.addLevelDir(levelPath, id);
+        ZipStream stream(levelPath.get());
+        downloader.setStream(&stream);
+        Progress& progress = Progress::getInstance();
+        progress.begin(Progress::Phase::Download, 0, 500);
 
         if (path.isFile()) {
             qWarning() << "File exists:" << path.get();
@@ -394,14 +461,40 @@ void Model::getLevel(int id) {
             qDebug() << "File does not exist:" << zipData.m_fileName;
             status = getLevelDontHaveFile(id, zipData.m_MD5sum, path);
         }
-        if (status == true) {
+        downloader.setStream(nullptr);
+
+        if ((status == true) && (stream.isComplete() == true)) {
+            // Extracted while it downloaded
+            fileManager.finishExtract(zipData);
+        } else if (status == true) {
+            // Not streamable or a local zip, use the central directory
+            progress.begin(Progress::Phase::Extract, 500, 1000);
             if (!fileManager.extractZip(zipData)) {
                 qDebug() << "unpackLevel failed";
+                status = false;
             }
+        } else if (stream.hasOutput() == true) {
+            (void)fileManager.cleanWorkingDir(levelPath);
+        }
+
+        if ((status == true) &&
+                g_settings.value("DedupeLevels", false).toBool()) {
+            FileStore store(storePath());
+            (void)store.addTree(levelPath.get());
+            const FileStore::Stats report = store.report();
+            qDebug() << "FileStore:" << report.files << "objects,"
+                     << report.bytes << "bytes, saving"
+                     << report.savedBytes << "bytes";
         }
         if (g_settings.value("DeleteZip").toBool()) {
             deleteZip(id);
         }
+
+        if (status == true) {
+            progress.finish();
+        } else {
+            progress.fail();
+        }
     }
 }
 
@@ -436,6 +529,10 @@ const QString Model::getWalkthrough(int id) {
     return data.getWalkthrough(id);
 }
 
+QVector<qint64> Model::searchLevels(const QString& text, int scope) {
+    return data.searchLevels(text, static_cast<Data::SearchScope>(scope));
+}
+
 void Model::killRunner() {
     m_runner.stop();
 }
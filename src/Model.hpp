@@ -29,6 +29,7 @@
 #include "../src/FileManager.hpp"
 #include "../src/Network.hpp"
 #include "../src/Runner.hpp"
+#include "../src/SaveStore.hpp"
 #include "../src/PyRunner.hpp"
 #include "../src/settings.hpp"
 
@@ -71,7 +72,15 @@ class Model : public QObject {
     bool deleteZip(int id);
     bool deleteLevel(int id);
     bool backupSaveFiles(int id);
-    void getList(QVector<QSharedPointer<ListItemData>>* list);
+    QVector<qint64> getSaveSnapshots(int id);
+    bool restoreSaveSnapshot(int id, qint64 snapshot);
+    /**
+     * @brief Emit the list page after a keyset position and advance it.
+     * @param release Release date of the last row of the previous page.
+     * @param trleId trle.net lid of the last row of the previous page.
+     * @return `true` if it was the last page.
+     */
+    bool getListPage(QString* release, qint64* trleId);
     void getCoverList(QVector<QSharedPointer<ListItemData>> tiems);
     int getItemState(int id);
     void run(RunnerOptions options);
@@ -83,6 +92,7 @@ class Model : public QObject {
     const InfoData getInfo(int id);
     const quint64 getType(qint64 id);
     const QString getWalkthrough(int id);
+    QVector<qint64> searchLevels(const QString& text, int scope);
     void killRunner();
     void clearRunner();
     void setup();
@@ -91,8 +101,9 @@ class Model : public QObject {
 
  signals:
     void generateListSignal(QList<int> availableGames);
-    void modelTickSignal();
     void modelReloadLevelListSignal();
+    void modelListPageSignal(
+        QVector<QSharedPointer<ListItemData>> page, bool last);
     void modelLoadingDoneSignal();
     void modelRunningDoneSignal();
 
@@ -101,9 +112,16 @@ class Model : public QObject {
         const int id, const QString& md5sum, Path path);
     bool getLevelDontHaveFile(
         const int id, const QString& md5sum, Path path);
+    /// FileStore directory the installed levels link into
+    QString storePath();
+    /// SaveStore directory of a level
+    QString savesPath(int id);
+    /// Retention from the SaveSnapshotsKeep settings
+    void pruneSaves(SaveStore* store);
 
     Runner m_runner;
     PyRunner m_pyRunner;
+    static constexpr qint64 m_listPageSize = 200;
 
     Data& data;
     FileManager& fileManager;
@@ -17,6 +17,7 @@
 #include <string>
 #include "../src/Network.hpp"
 #include "../src/Path.hpp"
+#include "../src/Progress.hpp"
 
 void Downloader::setUrl(QUrl url) {
     m_url = url;
@@ -30,11 +31,20 @@ int Downloader::getStatus() {
     return m_status;
 }
 
+void Downloader::setStream(ZipStream* stream) {
+    m_stream = stream;
+}
+
+QString Downloader::getMd5() {
+    return QString(m_md5.result().toHex());
+}
+
 void Downloader::run() {
     if (m_url.isEmpty() || m_saveFile.getRoot() != Path::resource) {
         m_status = 3;  // object error
     } else {
         m_status = 0;
+        m_md5.reset();
         qDebug() << "m_url: " << m_url.toString();
         qDebug() << "m_filePath: " << m_saveFile.get();
 
@@ -107,19 +117,30 @@ void Downloader::runConnect(QFile *file, const std::string& url) {
                 +[](const void* buf, size_t size, size_t nmemb, void* data)
                 -> size_t {
                     size_t writtenSize = 0;
-                    QFile* file = static_cast<QFile*>(data);
-                    if (file->isOpen() == true) {
-                        writtenSize = file->write(static_cast<const char*>(buf),
-                                size * nmemb);
+                    Downloader* downloader = static_cast<Downloader*>(data);
+                    const char* bytes = static_cast<const char*>(buf);
+                    const qint64 byteCount = size * nmemb;
+                    if (downloader->m_file->isOpen() == true) {
+                        writtenSize =
+                            downloader->m_file->write(bytes, byteCount);
+                    }
+                    // Hash and extract in the same pass as the write
+                    if (static_cast<qint64>(writtenSize) == byteCount) {
+                        downloader->m_md5.addData(
+                            QByteArrayView(bytes, byteCount));
+                        if (downloader->m_stream != nullptr) {
+                            (void)downloader->m_stream->feed(bytes, byteCount);
+                        }
                     }
                     // cppcheck-suppress misra-c2012-15.5
                     return writtenSize;
             });
         }
 
-        // The file object to save to
+        // The downloader saves to m_file
         if (status == CURLE_OK) {
-            status = curl_easy_setopt(curl, CURLOPT_WRITEDATA, file);
+            m_file = file;
+            status = curl_easy_setopt(curl, CURLOPT_WRITEDATA, this);
         }
 
         // Follow redirects
@@ -136,23 +157,11 @@ void Downloader::runConnect(QFile *file, const std::string& url) {
             status = curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION,
                 +[](void* clientp, curl_off_t dltotal, curl_off_t dlnow,
                     curl_off_t ultotal, curl_off_t ulnow) -> int {
-                    Downloader& downloader = Downloader::getInstance();
-
+                    // Only published here, the GUI samples it
                     if (dltotal > 0) {
-                        int& lastEmittedProgress =
-                            downloader.m_lastEmittedProgress;
-
-                        double progress = static_cast<double>(dlnow)
-                            / static_cast<double>(dltotal) * 50.0;
-
-                        if (static_cast<int>(progress) == 0) {
-                            lastEmittedProgress = 0;
-                        }
-                        if (static_cast<int>(progress) > lastEmittedProgress) {
-                            emit downloader.networkWorkTickSignal();
-                            QCoreApplication::processEvents();
-                            lastEmittedProgress = static_cast<int>(progress);
-                        }
+                        Progress::getInstance().update(
+                            static_cast<quint64>(dlnow),
+                            static_cast<quint64>(dltotal));
                     }
                     // cppcheck-suppress misra-c2012-15.5
                     return 0;
@@ -183,13 +192,10 @@ void Downloader::runConnect(QFile *file, const std::string& url) {
             if ((status == 6) || (status == 7) ||
                 (status == 28) || (status == 35)) {
                 emit this->networkWorkErrorSignal(1);
-                QCoreApplication::processEvents();
             } else if (status == CURLE_PEER_FAILED_VERIFICATION) {
                 emit this->networkWorkErrorSignal(2);
-                QCoreApplication::processEvents();
             } else {
                 emit this->networkWorkErrorSignal(3);
-                QCoreApplication::processEvents();
             }
         }
 
@@ -199,13 +205,13 @@ void Downloader::runConnect(QFile *file, const std::string& url) {
                 m_status = 6;
                 qDebug() << "Error: Downloaded zip is empty (0 bytes)";
                 emit this->networkWorkErrorSignal(4);
-                QCoreApplication::processEvents();
             } else {
                 m_status = 0;
                 qDebug() << "Downloaded successfully, size:" << file->size();
             }
         }
 
+        m_file = nullptr;
         curl_easy_cleanup(curl);
     }
 }
@@ -20,9 +20,11 @@
 #include <QDir>
 #include <QtCore>
 #include <QDebug>
+#include <QCryptographicHash>
 #include <curl/curl.h>
 #include <string>
 #include "../src/Path.hpp"
+#include "../src/ZipStream.hpp"
 
 class Downloader : public QObject {
     Q_OBJECT
@@ -39,8 +41,17 @@ class Downloader : public QObject {
     int getStatus();
     void setSaveFile(Path filePath);
 
+    /**
+     * @brief Also feed the downloaded bytes to a ZIP stream, nullptr for none.
+     */
+    void setStream(ZipStream* stream);
+
+    /**
+     * @brief MD5 of the last download, hashed as it was written.
+     */
+    QString getMd5();
+
  signals:
-    void networkWorkTickSignal();
     void networkWorkErrorSignal(int status);
 
  private:
@@ -49,13 +60,17 @@ class Downloader : public QObject {
     QUrl m_url;
     Path m_saveFile;
     qint32 m_status;
-    int m_lastEmittedProgress;
+    QFile* m_file;
+    ZipStream* m_stream;
+    QCryptographicHash m_md5;
 
     Downloader() :
         m_url(""),
         m_saveFile(Path(Path::resource)),
         m_status(0),
-        m_lastEmittedProgress(0) {
+        m_file(nullptr),
+        m_stream(nullptr),
+        m_md5(QCryptographicHash::Md5) {
         curl_global_init(CURL_GLOBAL_DEFAULT);
     }
 
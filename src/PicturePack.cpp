@@ -0,0 +1,144 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "../src/PicturePack.hpp"
+#include <QDebug>
+#include <QMutexLocker>
+#include <QtEndian>
+
+PicturePack::PicturePack() :
+        m_mappedSize(0) {
+}
+
+PicturePack::~PicturePack() {
+    close();
+}
+
+QByteArray PicturePack::makeHeader(qint64 generation) {
+    // Same bytes as tombll_common.picture_pack_header()
+    const quint32 fields[2] = {
+        qToLittleEndian(m_version),
+        qToLittleEndian(static_cast<quint32>(generation))
+    };
+    QByteArray header("TRLLPACK");
+    header.append(reinterpret_cast<const char*>(fields), sizeof(fields));
+    return header;
+}
+
+QString PicturePack::fileName(qint64 generation) {
+    return (generation == 0) ? QString("pictures.pack")
+        : QString("pictures.%1.pack").arg(generation);
+}
+
+bool PicturePack::open(const QString& filePath, qint64 generation) {
+    close();
+    QMutexLocker locker(&m_mutex);
+
+    m_file.setFileName(filePath);
+    bool status = m_file.open(QIODevice::ReadOnly);  // flawfinder: ignore
+    if (!status) {
+        qWarning() << "PicturePack: Could not open" << filePath
+                   << m_file.errorString();
+    }
+
+    if ((status == true) &&
+            (m_file.read(m_headerSize) != makeHeader(generation))) {
+        qWarning() << "PicturePack: Not a generation" << generation
+                   << "pack" << filePath;
+        status = false;
+    }
+
+    if (status == true) {
+        m_mappedSize = m_headerSize;
+        status = mapTail();
+    }
+
+    if (status == true) {
+        qDebug() << "PicturePack:" << m_mappedSize << "bytes in" << filePath;
+    } else {
+        m_file.close();
+    }
+    return status;
+}
+
+void PicturePack::close() {
+    QMutexLocker locker(&m_mutex);
+    for (const Segment& segment : m_segments) {
+        (void)m_file.unmap(segment.map);
+    }
+    m_segments.clear();
+    m_mappedSize = 0;
+    m_file.close();
+}
+
+bool PicturePack::mapTail() {
+    const qint64 fileSize = m_file.size();
+    bool status = true;
+    if (fileSize > m_mappedSize) {
+        const qint64 size = fileSize - m_mappedSize;
+        uchar* map = m_file.map(m_mappedSize, size);
+        if (map != nullptr) {
+            m_segments.append({m_mappedSize, size, map});
+            m_mappedSize = fileSize;
+        } else {
+            qWarning() << "PicturePack: Could not map" << m_file.fileName()
+                       << m_file.errorString();
+            status = false;
+        }
+    }
+    return status;
+}
+
+QByteArray PicturePack::span(qint64 offset, qint64 size) {
+    QMutexLocker locker(&m_mutex);
+    QByteArray result;
+
+    if (!m_file.isOpen() || (offset < m_headerSize) || (size <= 0)) {
+        return result;
+    }
+
+    // Pictures appended since the last read are past the mapped end
+    if ((offset + size) > m_mappedSize) {
+        (void)mapTail();
+    }
+
+    const Segment* found = nullptr;
+    for (const Segment& segment : m_segments) {
+        if ((offset >= segment.offset) &&
+                ((offset + size) <= (segment.offset + segment.size))) {
+            found = &segment;
+            break;
+        }
+    }
+
+    // A tail mapped while a picture was being appended splits it,
+    // give that picture a segment of its own
+    if ((found == nullptr) && ((offset + size) <= m_mappedSize)) {
+        uchar* map = m_file.map(offset, size);
+        if (map != nullptr) {
+            m_segments.append({offset, size, map});
+            found = &m_segments.last();
+        }
+    }
+
+    if (found != nullptr) {
+        result = QByteArray::fromRawData(
+            reinterpret_cast<const char*>(found->map) +
+                (offset - found->offset),
+            size);
+    } else {
+        qWarning() << "PicturePack: Picture at" << offset << "size" << size
+                   << "is outside the pack";
+    }
+    return result;
+}
@@ -0,0 +1,101 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef SRC_PICTUREPACK_HPP_
+#define SRC_PICTUREPACK_HPP_
+
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+/**
+ * @class PicturePack
+ * @brief Read-only view of the append-only picture pack next to tombll.db.
+ *
+ * The pack holds the WEBP covers and screenshots back to back, the
+ * PicturePack table maps each Picture.md5sum to an offset and size in it.
+ * tombll_manage_data.py appends new pictures at the end, so the file is
+ * mapped in segments, a read past the mapped end maps the new tail and old
+ * segments stay mapped. Spans handed out stay valid until close().
+ * Compacting writes a new pack file of the next generation, the database
+ * records the generation its offsets belong to.
+ *
+ * File layout:
+ * - Header: magic "TRLLPACK", version, generation.
+ * - Picture data, no per-entry framing.
+ */
+class PicturePack {
+ public:
+    PicturePack();
+    ~PicturePack();
+
+    /**
+     * @brief Open and map the pack file.
+     * @param filePath Full path to the pack file.
+     * @param generation Generation the database offsets point into.
+     * @return `true` if the pack can be used.
+     */
+    bool open(const QString& filePath, qint64 generation);
+
+    /**
+     * @brief File name of a pack generation, as tombll_common names it.
+     */
+    static QString fileName(qint64 generation);
+
+    /**
+     * @brief Unmap and close the pack file.
+     */
+    void close();
+
+    bool isOpen() const { return m_file.isOpen(); }
+
+    /**
+     * @brief Zero-copy view of a picture in the mapped pack.
+     *
+     * The QByteArray does not own its data, it points into the mapping.
+     *
+     * @param offset Byte offset from the PicturePack table.
+     * @param size Byte size from the PicturePack table.
+     * @return The picture data, empty if the range is outside the pack.
+     */
+    QByteArray span(qint64 offset, qint64 size);
+
+    static constexpr qint64 m_headerSize = 16;
+
+ private:
+    /**
+     * @struct Segment
+     * @brief One mapped range of the pack file.
+     */
+    struct Segment {
+        qint64 offset;
+        qint64 size;
+        uchar* map;
+    };
+
+    static QByteArray makeHeader(qint64 generation);
+    bool mapTail();
+
+    static constexpr quint32 m_version = 1;
+
+    QFile m_file;
+    QVector<Segment> m_segments;
+    qint64 m_mappedSize;
+    QMutex m_mutex;
+
+    Q_DISABLE_COPY(PicturePack)
+};
+
+#endif  // SRC_PICTUREPACK_HPP_
@@ -0,0 +1,92 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "../src/Progress.hpp"
+#include <algorithm>
+
+Progress::Progress() :
+        m_phase(static_cast<int>(Phase::Idle)),
+        m_from(0),
+        m_to(0),
+        m_done(0),
+        m_total(0),
+        m_lastPhase(Phase::Idle),
+        m_lastDone(0),
+        m_lastNs(0),
+        m_rate(0) {
+    m_clock.start();
+}
+
+void Progress::reset() {
+    begin(Phase::Idle, 0, 0);
+}
+
+void Progress::begin(Phase phase, int fromPermille, int toPermille) {
+    m_from.store(fromPermille, std::memory_order_relaxed);
+    m_to.store(toPermille, std::memory_order_relaxed);
+    m_done.store(0, std::memory_order_relaxed);
+    m_total.store(0, std::memory_order_relaxed);
+    // Published last, a sampler that sees the phase sees its range
+    m_phase.store(static_cast<int>(phase), std::memory_order_release);
+}
+
+void Progress::update(quint64 done, quint64 total) {
+    m_total.store(total, std::memory_order_relaxed);
+    m_done.store(done, std::memory_order_relaxed);
+}
+
+void Progress::finish() {
+    m_phase.store(static_cast<int>(Phase::Done), std::memory_order_release);
+}
+
+void Progress::fail() {
+    m_phase.store(static_cast<int>(Phase::Failed), std::memory_order_release);
+}
+
+Progress::Sample Progress::sample() {
+    Sample sample;
+    sample.phase = static_cast<Phase>(m_phase.load(std::memory_order_acquire));
+    const int from = m_from.load(std::memory_order_relaxed);
+    const int to = m_to.load(std::memory_order_relaxed);
+    sample.total = m_total.load(std::memory_order_relaxed);
+    sample.done = std::min(m_done.load(std::memory_order_relaxed),
+        sample.total);
+
+    if (sample.phase == Phase::Done) {
+        sample.permille = 1000;
+    } else if ((sample.phase == Phase::Idle) ||
+            (sample.phase == Phase::Failed)) {
+        sample.permille = 0;
+    } else if (sample.total == 0) {
+        sample.permille = from;
+    } else {
+        sample.permille = from + static_cast<int>(
+            (to - from) * static_cast<double>(sample.done) / sample.total);
+    }
+
+    // Throughput over at least a quarter second, reset by a new phase
+    const qint64 now = m_clock.nsecsElapsed();
+    if ((sample.phase != m_lastPhase) || (sample.done < m_lastDone)) {
+        m_lastPhase = sample.phase;
+        m_lastDone = sample.done;
+        m_lastNs = now;
+        m_rate = 0;
+    } else if (now - m_lastNs >= 250000000) {
+        m_rate = static_cast<quint64>((sample.done - m_lastDone) *
+            1000000000.0 / (now - m_lastNs));
+        m_lastDone = sample.done;
+        m_lastNs = now;
+    }
+    sample.bytesPerSecond = m_rate;
+    return sample;
+}
@@ -0,0 +1,107 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef SRC_PROGRESS_HPP_
+#define SRC_PROGRESS_HPP_
+
+#include <QElapsedTimer>
+#include <QtGlobal>
+
+#include <atomic>
+
+/**
+ * @class Progress
+ * @brief Byte progress of the running install, published by the workers.
+ *
+ * Workers store the phase and the bytes done and total in atomics, which
+ * never blocks them and never runs an event loop on their thread. The GUI
+ * reads it with sample() from a timer at display rate. Each phase covers
+ * a part of the whole bar, in permille, so a download and the following
+ * extraction make one bar.
+ */
+class Progress {
+ public:
+    /**
+     * Mayers thread safe singleton pattern.
+     */
+    static Progress& getInstance() {
+        // cppcheck-suppress threadsafety-threadsafety
+        static Progress instance;
+        return instance;
+    }
+
+    enum class Phase : int {
+        Idle,
+        Download,
+        Extract,
+        Copy,
+        Done,
+        Failed
+    };
+
+    /**
+     * @struct Sample
+     * @brief What the GUI shows of the progress.
+     */
+    struct Sample {
+        Phase phase;
+        quint64 done;
+        quint64 total;
+        int permille;          ///< Of the whole install, 0 to 1000
+        quint64 bytesPerSecond;
+    };
+
+    /**
+     * @brief Forget the last install, before new work is queued.
+     */
+    void reset();
+
+    /**
+     * @brief Start a phase that fills the bar from one permille to another.
+     */
+    void begin(Phase phase, int fromPermille, int toPermille);
+
+    /**
+     * @brief Publish the bytes of the current phase, from any thread.
+     */
+    void update(quint64 done, quint64 total);
+
+    void finish();
+    void fail();
+
+    /**
+     * @brief Read the progress and the throughput since the last sample.
+     * @note Only one thread may sample, the GUI thread.
+     */
+    Sample sample();
+
+ private:
+    Progress();
+
+    std::atomic<int> m_phase;
+    std::atomic<int> m_from;
+    std::atomic<int> m_to;
+    std::atomic<quint64> m_done;
+    std::atomic<quint64> m_total;
+
+    // Owned by the sampling thread
+    QElapsedTimer m_clock;
+    Phase m_lastPhase;
+    quint64 m_lastDone;
+    qint64 m_lastNs;
+    quint64 m_rate;
+
+    Q_DISABLE_COPY(Progress)
+};
+
+#endif  // SRC_PROGRESS_HPP_
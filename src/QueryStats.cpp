@@ -0,0 +1,139 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "../src/QueryStats.hpp"
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QVariant>
+#include <algorithm>
+#include "../src/settings.hpp"
+
+QueryStats::QueryStats() :
+        m_slowQueryMs(getSettingsInstance().value(
+            "slowQueryMs", 100).toLongLong()) {
+}
+
+void QueryStats::record(const QString& name, qint64 nanoseconds,
+        qint64 rows, qint64 bytes) {
+    const quint64 us = static_cast<quint64>(std::max<qint64>(
+        nanoseconds / 1000, 1));
+    qint64 bucket = 0;
+    while (((us >> (bucket + 1)) != 0) && (bucket < m_bucketCount - 1)) {
+        bucket++;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    Histogram& histogram = m_histograms[name];
+    histogram.count++;
+    histogram.rows += rows;
+    histogram.bytes += bytes;
+    histogram.totalNs += nanoseconds;
+    histogram.maxNs = std::max<quint64>(histogram.maxNs, nanoseconds);
+    histogram.buckets[bucket]++;
+}
+
+qint64 QueryStats::percentileUs(const Histogram& histogram, double fraction) {
+    // Upper edge of the bucket holding the sample, never more than the max
+    const quint64 rank = static_cast<quint64>(fraction * histogram.count);
+    quint64 seen = 0;
+    qint64 result = 0;
+    for (qint64 bucket = 0; bucket < m_bucketCount; bucket++) {
+        seen += histogram.buckets[bucket];
+        if (seen > rank) {
+            result = qint64(2) << bucket;
+            break;
+        }
+    }
+    return std::min<qint64>(result, histogram.maxNs / 1000);
+}
+
+QJsonObject QueryStats::toJson() const {
+    QMutexLocker locker(&m_mutex);
+    QJsonObject queries;
+    for (auto it = m_histograms.constBegin();
+            it != m_histograms.constEnd(); ++it) {
+        const Histogram& histogram = it.value();
+        QJsonObject entry;
+        entry["count"] = static_cast<qint64>(histogram.count);
+        entry["p50_us"] = percentileUs(histogram, 0.50);
+        entry["p95_us"] = percentileUs(histogram, 0.95);
+        entry["max_us"] = static_cast<qint64>(histogram.maxNs / 1000);
+        entry["mean_us"] = static_cast<qint64>(
+            histogram.totalNs / histogram.count / 1000);
+        entry["rows"] = static_cast<qint64>(histogram.rows);
+        entry["bytes"] = static_cast<qint64>(histogram.bytes);
+        queries[it.key()] = entry;
+    }
+
+    QJsonObject result;
+    result["slowQueryMs"] = m_slowQueryMs.load();
+    result["queries"] = queries;
+    return result;
+}
+
+bool QueryStats::writeJson(const QString& filePath) const {
+    QFile file(filePath);
+    bool status = file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    if (status == true) {
+        const QByteArray json = QJsonDocument(toJson()).toJson();
+        status = file.write(json) == json.size();
+    }
+    if (status == true) {
+        qDebug() << "Query stats written to" << filePath;
+    } else {
+        qWarning() << "Error writing query stats to" << filePath
+                   << file.errorString();
+    }
+    return status;
+}
+
+void QueryStats::clear() {
+    QMutexLocker locker(&m_mutex);
+    m_histograms.clear();
+}
+
+QueryTimer::QueryTimer(const QString& name, const QSqlQuery* query) :
+        m_name(name),
+        m_query(query),
+        m_rows(0),
+        m_bytes(0) {
+    m_timer.start();
+}
+
+QueryTimer::~QueryTimer() {
+    const qint64 nanoseconds = m_timer.nsecsElapsed();
+    QueryStats& stats = QueryStats::getInstance();
+    stats.record(m_name, nanoseconds, m_rows, m_bytes);
+
+    const qint64 slowMs = stats.getSlowQueryMs();
+    if ((slowMs > 0) && ((nanoseconds / 1000000) >= slowMs)) {
+        QStringList values;
+        if (m_query != nullptr) {
+            for (const QVariant& value : m_query->boundValues()) {
+                if (value.typeId() == QMetaType::QByteArray) {
+                    values << QString("<%1 bytes>")
+                        .arg(value.toByteArray().size());
+                } else {
+                    values << value.toString().left(64);
+                }
+            }
+        }
+        qWarning().noquote() << "Slow query" << m_name << "took"
+            << (nanoseconds / 1000000) << "ms," << m_rows << "rows:"
+            << (m_query != nullptr ? m_query->lastQuery() : QString())
+            << "bound [" << values.join(", ") << "]";
+    }
+}
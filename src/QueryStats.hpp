@@ -0,0 +1,143 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef SRC_QUERYSTATS_HPP_
+#define SRC_QUERYSTATS_HPP_
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSqlQuery>
+#include <QString>
+
+#include <array>
+#include <atomic>
+
+/**
+ * @class QueryStats
+ * @brief Latency histograms of the Data layer queries.
+ *
+ * Every query records its time, rows and bytes under its name. Times go in
+ * power of two microsecond buckets, so percentiles are accurate to a factor
+ * of two and recording is a few additions under a mutex. A query slower than
+ * the slow-query threshold is logged with its SQL and bound values.
+ */
+class QueryStats {
+ public:
+    /**
+     * Mayers thread safe singleton pattern.
+     */
+    static QueryStats& getInstance() {
+        // cppcheck-suppress threadsafety-threadsafety
+        static QueryStats instance;
+        return instance;
+    }
+
+    /**
+     * @brief Add one query run to the histogram of its name.
+     * @param name Query name, usually the Data::Statement name.
+     * @param nanoseconds Time from start to the last row read.
+     * @param rows Rows read.
+     * @param bytes Text and picture bytes read.
+     */
+    void record(const QString& name, qint64 nanoseconds,
+            qint64 rows, qint64 bytes);
+
+    /**
+     * @brief Queries slower than this are logged, 0 turns the log off.
+     *
+     * Starts from the slowQueryMs setting, 100 ms if it's not set.
+     */
+    qint64 getSlowQueryMs() const { return m_slowQueryMs.load(); }
+    void setSlowQueryMs(qint64 milliseconds) {
+        m_slowQueryMs = milliseconds;
+    }
+
+    /**
+     * @brief Stats per query name: count, p50/p95/max/mean in microseconds,
+     * rows and bytes.
+     */
+    QJsonObject toJson() const;
+
+    /**
+     * @brief Write toJson() to a file.
+     * @param filePath Full path of the JSON file.
+     * @return `true` if it was written.
+     */
+    bool writeJson(const QString& filePath) const;
+
+    /**
+     * @brief Drop all recorded stats.
+     */
+    void clear();
+
+ private:
+    QueryStats();
+
+    /// Bucket i counts times in [2^i, 2^(i+1)) microseconds
+    static constexpr qint64 m_bucketCount = 32;
+
+    /**
+     * @struct Histogram
+     * @brief Recorded runs of one query.
+     */
+    struct Histogram {
+        quint64 count = 0;
+        quint64 rows = 0;
+        quint64 bytes = 0;
+        quint64 totalNs = 0;
+        quint64 maxNs = 0;
+        std::array<quint64, m_bucketCount> buckets = {};
+    };
+
+    static qint64 percentileUs(const Histogram& histogram, double fraction);
+
+    QHash<QString, Histogram> m_histograms;
+    mutable QMutex m_mutex;
+    std::atomic<qint64> m_slowQueryMs;
+
+    Q_DISABLE_COPY(QueryStats)
+};
+
+/**
+ * @class QueryTimer
+ * @brief Times a query on the monotonic clock until it goes out of scope.
+ *
+ * Create it before exec(), count rows and bytes while reading and let the
+ * destructor record the run, or log it if it was slow.
+ */
+class QueryTimer {
+ public:
+    /**
+     * @param name Query name in the stats.
+     * @param query The query, for the slow-query log, may be nullptr.
+     */
+    explicit QueryTimer(const QString& name,
+            const QSqlQuery* query = nullptr);
+    ~QueryTimer();
+
+    void addRow() { m_rows++; }
+    void addBytes(qint64 bytes) { m_bytes += bytes; }
+
+ private:
+    QElapsedTimer m_timer;
+    QString m_name;
+    const QSqlQuery* m_query;
+    qint64 m_rows;
+    qint64 m_bytes;
+
+    Q_DISABLE_COPY(QueryTimer)
+};
+
+#endif  // SRC_QUERYSTATS_HPP_
@@ -0,0 +1,356 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "../src/SaveStore.hpp"
+#include <QCryptographicHash>
+#include <QDate>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QSet>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <zstd.h>
+#include <algorithm>
+
+namespace {
+
+/// Saves are small, a high level still takes a millisecond or two
+constexpr int compressionLevel = 9;
+
+QString hashContent(const QByteArray& content) {
+    return QString(QCryptographicHash::hash(
+        content, QCryptographicHash::Blake2b_256).toHex());
+}
+
+}  // namespace
+
+SaveStore::SaveStore(const QString& root, const QString& levelDir) :
+        m_root(root),
+        m_levelDir(levelDir) {
+}
+
+QString SaveStore::objectPath(const QString& hash) const {
+    return QString("%1/objects/%2/%3").arg(m_root, hash.left(2), hash);
+}
+
+QString SaveStore::manifestPath(qint64 id) const {
+    return QString("%1/snapshots/%2").arg(m_root).arg(id);
+}
+
+int SaveStore::snapshot(const QStringList& saveFiles, qint64* id) {
+    QElapsedTimer timer;
+    timer.start();
+
+    const QVector<qint64> ids = list();
+    QVector<Entry> last;
+    if (!ids.isEmpty() && !readManifest(ids.last(), &last)) {
+        last.clear();  // Compare against nothing, read every save
+    }
+    QHash<QString, Entry> previous;
+    for (const Entry& entry : last) {
+        previous.insert(entry.path, entry);
+    }
+
+    const QDir level(m_levelDir);
+    QVector<Entry> entries;
+    entries.reserve(saveFiles.size());
+    qint64 read = 0;
+    for (const QString& file : saveFiles) {
+        struct stat st;
+        if (stat(QFile::encodeName(file).constData(), &st) != 0) {
+            qWarning() << "SaveStore: Could not stat" << file;
+            return 2;
+        }
+        Entry entry;
+        entry.path = level.relativeFilePath(file);
+        entry.size = static_cast<qint64>(st.st_size);
+        entry.mtimeNs = static_cast<qint64>(st.st_mtim.tv_sec) * 1000000000 +
+            st.st_mtim.tv_nsec;
+
+        const auto it = previous.constFind(entry.path);
+        if ((it != previous.constEnd()) && (it->size == entry.size) &&
+                (it->mtimeNs == entry.mtimeNs)) {
+            entry.hash = it->hash;  // Unchanged, not read
+        } else {
+            QFile save(file);
+            if (!save.open(QIODevice::ReadOnly)) {  // flawfinder: ignore
+                qWarning() << "SaveStore: Could not read" << file
+                           << save.errorString();
+                return 2;
+            }
+            const QByteArray content = save.readAll();
+            entry.size = content.size();
+            entry.hash = hashContent(content);
+            if (!writeObject(entry.hash, content)) {
+                return 3;
+            }
+            read++;
+        }
+        entries.append(entry);
+    }
+    std::sort(entries.begin(), entries.end(),
+        [](const Entry& a, const Entry& b) { return a.path < b.path; });
+
+    bool same = (entries.size() == last.size());
+    bool touched = false;
+    for (qint64 i = 0; (same == true) && (i < entries.size()); i++) {
+        same = (entries[i].path == last[i].path) &&
+            (entries[i].hash == last[i].hash);
+        touched = touched || (entries[i].mtimeNs != last[i].mtimeNs);
+    }
+    if (same == true) {
+        // Same content, keep the new mtimes so the saves aren't read again
+        if ((touched == true) && !writeManifest(ids.last(), entries)) {
+            return 3;
+        }
+        qDebug() << "SaveStore: No saves changed in" << m_levelDir
+                 << "checked in" << timer.elapsed() << "ms";
+        return 1;
+    }
+
+    qint64 next = QDateTime::currentMSecsSinceEpoch();
+    if (!ids.isEmpty() && (next <= ids.last())) {
+        next = ids.last() + 1;
+    }
+    if (!writeManifest(next, entries)) {
+        return 3;
+    }
+    if (id != nullptr) {
+        *id = next;
+    }
+    qDebug() << "SaveStore: Snapshot" << next << "of" << entries.size()
+             << "saves," << read << "changed, in" << timer.elapsed() << "ms";
+    return 0;
+}
+
+QVector<qint64> SaveStore::list() const {
+    QVector<qint64> ids;
+    const QStringList names =
+        QDir(m_root + "/snapshots").entryList(QDir::Files);
+    for (const QString& name : names) {
+        bool ok = false;
+        const qint64 id = name.toLongLong(&ok);
+        if (ok == true) {
+            ids.append(id);
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+bool SaveStore::restore(qint64 id) {
+    QVector<Entry> entries;
+    if (!readManifest(id, &entries)) {
+        qWarning() << "SaveStore: No snapshot" << id << "in" << m_root;
+        return false;
+    }
+
+    bool status = true;
+    const QDir level(m_levelDir);
+    for (const Entry& entry : entries) {
+        QByteArray content;
+        if (!readObject(entry.hash, &content) ||
+                (hashContent(content) != entry.hash)) {
+            qWarning() << "SaveStore: Damaged object for" << entry.path;
+            status = false;
+            continue;
+        }
+        const QString target = level.filePath(entry.path);
+        (void)QDir().mkpath(QFileInfo(target).path());
+        QSaveFile file(target);
+        if (!file.open(QIODevice::WriteOnly) ||
+                (file.write(content) != content.size()) || !file.commit()) {
+            qWarning() << "SaveStore: Could not restore" << target
+                       << file.errorString();
+            status = false;
+            continue;
+        }
+        // The next snapshot sees it as unchanged
+        const struct timespec times[2] = {
+            {0, UTIME_OMIT},
+            {static_cast<time_t>(entry.mtimeNs / 1000000000),
+                static_cast<long>(entry.mtimeNs % 1000000000)}
+        };
+        (void)utimensat(AT_FDCWD, QFile::encodeName(target).constData(),
+            times, 0);
+    }
+    qDebug() << "SaveStore: Restored snapshot" << id << "of"
+             << entries.size() << "saves to" << m_levelDir;
+    return status;
+}
+
+bool SaveStore::restore(qint64 id, const QStringList& saveFiles) {
+    if (snapshot(saveFiles) > 1) {
+        qWarning() << "SaveStore: Could not snapshot the saves in"
+                   << m_levelDir << "before the restore";
+        return false;
+    }
+    return restore(id);
+}
+
+qint64 SaveStore::prune(qint64 keepLast, qint64 keepDays) {
+    const QVector<qint64> ids = list();
+    QSet<qint64> keep;
+    QSet<QDate> days;
+    for (qint64 i = ids.size() - 1; i >= 0; i--) {
+        const qint64 id = ids[i];
+        const QDate day = QDateTime::fromMSecsSinceEpoch(id).date();
+        if (ids.size() - i <= keepLast) {
+            keep.insert(id);
+        } else if (!days.contains(day) && (days.size() < keepDays)) {
+            keep.insert(id);
+        }
+        days.insert(day);
+    }
+
+    qint64 removed = 0;
+    for (const qint64 id : ids) {
+        if (!keep.contains(id) && QFile::remove(manifestPath(id))) {
+            removed++;
+        }
+    }
+    if (removed == 0) {
+        return removed;
+    }
+
+    // Objects no kept snapshot uses
+    QSet<QString> used;
+    for (const qint64 id : keep) {
+        QVector<Entry> entries;
+        if (!readManifest(id, &entries)) {
+            qWarning() << "SaveStore: Unreadable snapshot" << id
+                       << "keeping all objects";
+            return removed;
+        }
+        for (const Entry& entry : entries) {
+            used.insert(entry.hash);
+        }
+    }
+    qint64 objects = 0;
+    QDirIterator it(m_root + "/objects", QDir::Files,
+        QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        if (!used.contains(it.fileName()) && QFile::remove(path)) {
+            objects++;
+        }
+    }
+    qDebug() << "SaveStore: Pruned" << removed << "snapshots and"
+             << objects << "objects of" << m_levelDir;
+    return removed;
+}
+
+bool SaveStore::readManifest(qint64 id, QVector<Entry>* entries) const {
+    QFile file(manifestPath(id));
+    if (!file.open(QIODevice::ReadOnly)) {  // flawfinder: ignore
+        return false;
+    }
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    if (lines.isEmpty() || (lines.first() != m_manifestHeader)) {
+        return false;
+    }
+    for (qint64 i = 1; i < lines.size(); i++) {
+        if (lines[i].isEmpty()) {
+            continue;
+        }
+        // The path goes last, it may hold anything but a newline
+        const QList<QByteArray> fields = lines[i].split('\t');
+        if (fields.size() < 4) {
+            return false;
+        }
+        Entry entry;
+        entry.hash = QString::fromLatin1(fields[0]);
+        entry.size = fields[1].toLongLong();
+        entry.mtimeNs = fields[2].toLongLong();
+        entry.path = QString::fromUtf8(
+            lines[i].mid(fields[0].size() + fields[1].size() +
+                fields[2].size() + 3));
+        entries->append(entry);
+    }
+    return true;
+}
+
+bool SaveStore::writeManifest(qint64 id, const QVector<Entry>& entries) {
+    QByteArray text(m_manifestHeader);
+    text.append('\n');
+    for (const Entry& entry : entries) {
+        text.append(entry.hash.toLatin1()).append('\t')
+            .append(QByteArray::number(entry.size)).append('\t')
+            .append(QByteArray::number(entry.mtimeNs)).append('\t')
+            .append(entry.path.toUtf8()).append('\n');
+    }
+
+    const QString path = manifestPath(id);
+    (void)QDir().mkpath(QFileInfo(path).path());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) ||
+            (file.write(text) != text.size()) || !file.commit()) {
+        qWarning() << "SaveStore: Could not write" << path
+                   << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool SaveStore::writeObject(const QString& hash, const QByteArray& content) {
+    const QString path = objectPath(hash);
+    if (QFileInfo::exists(path)) {
+        return true;  // Saved by an earlier snapshot
+    }
+
+    QByteArray frame(
+        static_cast<qsizetype>(ZSTD_compressBound(content.size())),
+        Qt::Uninitialized);
+    const size_t size = ZSTD_compress(frame.data(), frame.size(),
+        content.constData(), content.size(), compressionLevel);
+    if (ZSTD_isError(size)) {
+        qWarning() << "SaveStore: zstd failed:" << ZSTD_getErrorName(size);
+        return false;
+    }
+    frame.truncate(static_cast<qsizetype>(size));
+
+    (void)QDir().mkpath(QFileInfo(path).path());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) ||
+            (file.write(frame) != frame.size()) || !file.commit()) {
+        qWarning() << "SaveStore: Could not write" << path
+                   << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool SaveStore::readObject(const QString& hash, QByteArray* content) const {
+    QFile file(objectPath(hash));
+    if (!file.open(QIODevice::ReadOnly)) {  // flawfinder: ignore
+        return false;
+    }
+    const QByteArray frame = file.readAll();
+    const unsigned long long size =
+        ZSTD_getFrameContentSize(frame.constData(), frame.size());
+    if ((size == ZSTD_CONTENTSIZE_ERROR) ||
+            (size == ZSTD_CONTENTSIZE_UNKNOWN)) {
+        return false;
+    }
+    content->resize(static_cast<qsizetype>(size));
+    const size_t done = ZSTD_decompress(content->data(), content->size(),
+        frame.constData(), frame.size());
+    return !ZSTD_isError(done) && (done == size);
+}
@@ -0,0 +1,113 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef SRC_SAVESTORE_HPP_
+#define SRC_SAVESTORE_HPP_
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @class SaveStore
+ * @brief Snapshots of the save files of one level.
+ *
+ * A snapshot is a manifest in <root>/snapshots/<id> listing each save
+ * file with its size, nanosecond mtime and BLAKE2b. The contents are zstd
+ * compressed objects in <root>/objects/<2 hex>/<hash>, shared by all
+ * snapshots. A save with the size and mtime it had in the last snapshot is
+ * not read again, and a snapshot that would equal the last is not written.
+ * The snapshot id is its time in milliseconds since the epoch.
+ */
+class SaveStore {
+ public:
+    /**
+     * @struct Entry
+     * @brief One save file in a snapshot.
+     */
+    struct Entry {
+        QString path;  ///< Relative to the level directory
+        qint64 size = 0;
+        qint64 mtimeNs = 0;
+        QString hash;
+    };
+
+    /**
+     * @param root Snapshot directory of the level.
+     * @param levelDir Level directory the save paths are relative to.
+     */
+    SaveStore(const QString& root, const QString& levelDir);
+
+    /**
+     * @brief Store the save files, only the ones that changed are read.
+     * @param saveFiles Full paths of the save files in the level directory.
+     * @param id Set to the new snapshot id, if one was written.
+     * @return int Status code:
+     *         - 0: Snapshot written.
+     *         - 1: Nothing changed since the last snapshot.
+     *         - 2: A save file could not be read.
+     *         - 3: The snapshot could not be written.
+     */
+    int snapshot(const QStringList& saveFiles, qint64* id = nullptr);
+
+    /**
+     * @brief Snapshot ids, oldest first.
+     */
+    QVector<qint64> list() const;
+
+    /**
+     * @brief Write the save files of a snapshot back.
+     *
+     * Each file is replaced in one rename and gets its old mtime. Save
+     * files made after the snapshot are left as they are.
+     *
+     * @return `true` if every file was restored.
+     */
+    bool restore(qint64 id);
+
+    /**
+     * @brief Snapshot the current saves, then restore a snapshot.
+     *
+     * The saves it replaces can be restored too. Nothing is pruned, so
+     * the snapshot asked for is still there when it is restored.
+     *
+     * @param id Snapshot to restore.
+     * @param saveFiles Full paths of the save files in the level directory.
+     * @return `true` if every file was restored.
+     */
+    bool restore(qint64 id, const QStringList& saveFiles);
+
+    /**
+     * @brief Retention, remove old snapshots and the objects only they used.
+     * @param keepLast Newest snapshots kept.
+     * @param keepDays Also keep the newest snapshot of this many days.
+     * @return Number of snapshots removed.
+     */
+    qint64 prune(qint64 keepLast, qint64 keepDays);
+
+ private:
+    bool readManifest(qint64 id, QVector<Entry>* entries) const;
+    bool writeManifest(qint64 id, const QVector<Entry>& entries);
+    bool writeObject(const QString& hash, const QByteArray& content);
+    bool readObject(const QString& hash, QByteArray* content) const;
+    QString objectPath(const QString& hash) const;
+    QString manifestPath(qint64 id) const;
+
+    /// Magic first line of a manifest
+    static constexpr const char* m_manifestHeader = "trll-saves 1";
+
+    QString m_root;
+    QString m_levelDir;
+};
+
+#endif  // SRC_SAVESTORE_HPP_
@@ -0,0 +1,239 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "../src/TrashReaper.hpp"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../src/FileStore.hpp"
+
+namespace {
+
+// ioprio_set() has no glibc wrapper, these are from linux/ioprio.h
+constexpr int ioprioWhoProcess = 1;
+constexpr int ioprioClassIdle = 3;
+constexpr int ioprioClassShift = 13;
+
+bool isDotOrDotDot(const char* name) {
+    return (strcmp(name, ".") == 0) || (strcmp(name, "..") == 0);
+}
+
+}  // namespace
+
+TrashReaper::TrashReaper() :
+        m_pending(false),
+        m_running(false),
+        m_stop(false),
+        m_freedBytes(0),
+        m_counter(0) {
+}
+
+TrashReaper::~TrashReaper() {
+    if (!m_thread.isNull()) {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stop = true;
+        }
+        m_wake.wakeAll();
+        // Unfinished trash is reaped on the next start
+        (void)m_thread->wait();
+    }
+}
+
+void TrashReaper::start(const QString& trashDir, const QString& storeDir) {
+    if (m_running.load() == true) {
+        return;
+    }
+    if (!QDir().mkpath(trashDir)) {
+        qWarning() << "TrashReaper: Could not create" << trashDir;
+        return;
+    }
+    m_trashDir = trashDir;
+    m_storeDir = storeDir;
+    m_pending = true;  // Reap what the last run left first
+    m_thread.reset(QThread::create([this]() { reapLoop(); }));
+    m_thread->setObjectName("TrashReaper");
+    m_thread->start(QThread::IdlePriority);
+    m_running = true;
+}
+
+bool TrashReaper::trash(const QString& path) {
+    if (m_running.load() == false) {
+        return false;
+    }
+    const QString target = QString("%1/%2-%3-%4").arg(m_trashDir)
+        .arg(QDateTime::currentMSecsSinceEpoch())
+        .arg(m_counter.fetch_add(1))
+        .arg(QFileInfo(path).fileName());
+    if (rename(QFile::encodeName(path).constData(),
+            QFile::encodeName(target).constData()) != 0) {
+        qWarning() << "TrashReaper: Could not move" << path
+                   << "to the trash:" << strerror(errno);
+        return false;
+    }
+    qDebug() << "TrashReaper: Moved" << path << "to the trash";
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pending = true;
+    }
+    m_wake.wakeOne();
+    return true;
+}
+
+void TrashReaper::reapLoop() {
+    // Only use the disk when nothing else does
+    if (syscall(SYS_ioprio_set, ioprioWhoProcess, 0,
+            ioprioClassIdle << ioprioClassShift) != 0) {
+        qDebug() << "TrashReaper: No idle I/O priority:" << strerror(errno);
+    }
+
+    bool running = true;
+    while (running) {
+        {
+            QMutexLocker locker(&m_mutex);
+            while ((m_pending == false) && (m_stop.load() == false)) {
+                m_wake.wait(&m_mutex);
+            }
+            running = !m_stop.load();
+            m_pending = false;
+        }
+        if (running == true) {
+            const quint64 freed = reapAll();
+            if (freed > 0) {
+                m_freedBytes += freed;
+                emit spaceFreedSignal(freed);
+            }
+        }
+    }
+}
+
+quint64 TrashReaper::reapAll() {
+    quint64 freed = 0;
+    const int fd = open(QFile::encodeName(m_trashDir).constData(),
+        O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    DIR* dir = (fd >= 0) ? fdopendir(fd) : nullptr;
+    if (dir == nullptr) {
+        qWarning() << "TrashReaper: Could not open" << m_trashDir;
+        if (fd >= 0) {
+            (void)close(fd);
+        }
+        return freed;
+    }
+
+    std::vector<std::string> entries;
+    const struct dirent* entry = nullptr;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (!isDotOrDotDot(entry->d_name)) {
+            entries.emplace_back(entry->d_name);
+        }
+    }
+
+    qint64 reaped = 0;
+    for (const std::string& name : entries) {
+        if (m_stop.load() == true) {
+            break;
+        }
+        if (removeTree(dirfd(dir), name.c_str(), &freed) == true) {
+            reaped++;
+        } else if (m_stop.load() == false) {
+            qWarning() << "TrashReaper: Could not remove all of"
+                       << QString::fromStdString(name);
+        }
+    }
+    (void)closedir(dir);
+
+    // The reaped levels were the last links to some objects
+    if ((reaped > 0) && (m_stop.load() == false) &&
+            !m_storeDir.isEmpty() && QFileInfo(m_storeDir).isDir()) {
+        freed += FileStore(m_storeDir).collectGarbage().bytes;
+    }
+    if (reaped > 0) {
+        qDebug() << "TrashReaper: Reaped" << reaped << "entries,"
+                 << freed << "bytes freed";
+    }
+    return freed;
+}
+
+bool TrashReaper::removeTree(int parentFd, const char* name, quint64* freed) {
+    struct stat st;
+    if (fstatat(parentFd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+        return errno == ENOENT;
+    }
+
+    if (S_ISDIR(st.st_mode)) {
+        if ((st.st_mode & S_IRWXU) != S_IRWXU) {
+            (void)fchmodat(parentFd, name, st.st_mode | S_IRWXU, 0);
+        }
+        const int fd = openat(parentFd, name,
+            O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        DIR* dir = (fd >= 0) ? fdopendir(fd) : nullptr;
+        if (dir == nullptr) {
+            if (fd >= 0) {
+                (void)close(fd);
+            }
+            return false;
+        }
+
+        // Read a batch of names, unlink them, then read again
+        bool status = true;
+        std::vector<std::string> batch;
+        while (status == true) {
+            batch.clear();
+            rewinddir(dir);
+            const struct dirent* entry = nullptr;
+            while ((batch.size() < static_cast<size_t>(m_batchSize)) &&
+                    ((entry = readdir(dir)) != nullptr)) {
+                if (!isDotOrDotDot(entry->d_name)) {
+                    batch.emplace_back(entry->d_name);
+                }
+            }
+            if (batch.empty()) {
+                break;
+            }
+            for (const std::string& child : batch) {
+                if (removeTree(dirfd(dir), child.c_str(), freed) == false) {
+                    status = false;
+                }
+            }
+            if (m_stop.load() == true) {
+                status = false;
+            }
+        }
+        (void)closedir(dir);
+        return (status == true) &&
+            (unlinkat(parentFd, name, AT_REMOVEDIR) == 0);
+    }
+
+    if (unlinkat(parentFd, name, 0) != 0) {
+        return errno == ENOENT;
+    }
+    // Space of a store object is freed with its last link
+    if (st.st_nlink == 1) {
+        *freed += static_cast<quint64>(st.st_blocks) * 512;
+    }
+    return true;
+}
@@ -0,0 +1,101 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef SRC_TRASHREAPER_HPP_
+#define SRC_TRASHREAPER_HPP_
+
+#include <QMutex>
+#include <QObject>
+#include <QScopedPointer>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <atomic>
+
+/**
+ * @class TrashReaper
+ * @brief Deletes levels and zips in the background.
+ *
+ * trash() renames a file or directory into the trash directory, which
+ * takes the same time for a few bytes as for a level of many GB. A reaper
+ * thread with idle CPU and I/O priority then unlinks the trash with
+ * unlinkat(), in batches. Trash left by a run that ended early is reaped
+ * when the reaper starts. Once a pass is done the FileStore objects no
+ * level links to anymore are removed too.
+ */
+class TrashReaper : public QObject {
+    Q_OBJECT
+
+ public:
+    /**
+     * Mayers thread safe singleton pattern.
+     */
+    static TrashReaper& getInstance() {
+        // cppcheck-suppress threadsafety-threadsafety
+        static TrashReaper instance;
+        return instance;
+    }
+
+    /**
+     * @brief Start the reaper, it first reaps what is already in the trash.
+     * @param trashDir Trash directory, on the filesystem of what is trashed.
+     * @param storeDir FileStore to collect garbage in after a pass,
+     *        empty for none.
+     */
+    void start(const QString& trashDir, const QString& storeDir);
+
+    /**
+     * @brief Move a file or directory into the trash in one rename.
+     * @param path File or directory to delete.
+     * @return `true` if it was moved, `false` if the caller has to remove
+     *         it, like when the reaper is not started.
+     */
+    bool trash(const QString& path);
+
+    /**
+     * @brief Bytes given back to the filesystem since start().
+     */
+    quint64 getFreedBytes() const { return m_freedBytes.load(); }
+
+ signals:
+    /**
+     * @brief Emitted from the reaper thread after a pass freed space.
+     */
+    void spaceFreedSignal(quint64 bytes);
+
+ private:
+    TrashReaper();
+    ~TrashReaper();
+    void reapLoop();
+    quint64 reapAll();
+    bool removeTree(int parentFd, const char* name, quint64* freed);
+
+    /// Unlinks between checks for stop
+    static constexpr int m_batchSize = 256;
+
+    QString m_trashDir;
+    QString m_storeDir;
+    QScopedPointer<QThread> m_thread;
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    bool m_pending;
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_stop;
+    std::atomic<quint64> m_freedBytes;
+    std::atomic<quint64> m_counter;
+
+    Q_DISABLE_COPY(TrashReaper)
+};
+
+#endif  // SRC_TRASHREAPER_HPP_
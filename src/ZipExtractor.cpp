@@ -0,0 +1,256 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "../src/ZipExtractor.hpp"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSet>
+#include <QThreadPool>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include "../miniz/miniz.h"  // IWYU pragma: keep
+#include "../miniz/miniz_zip.h"
+
+namespace {
+
+/**
+ * @struct EntryWriter
+ * @brief Output file and byte counter of the entry being inflated.
+ */
+struct EntryWriter {
+    QFile* file;
+    std::atomic<quint64>* doneBytes;
+};
+
+size_t writeEntry(void* opaque, mz_uint64 offset, const void* data, size_t n) {
+    (void)offset;  // miniz hands the data over in order
+    EntryWriter* writer = static_cast<EntryWriter*>(opaque);
+    const qint64 written =
+        writer->file->write(static_cast<const char*>(data), n);
+    if (written != static_cast<qint64>(n)) {
+        return 0;
+    }
+    writer->doneBytes->fetch_add(n, std::memory_order_relaxed);
+    return n;
+}
+
+}  // namespace
+
+ZipExtractor::ZipExtractor() :
+        m_map(nullptr),
+        m_mapSize(0),
+        m_totalBytes(0),
+        m_doneBytes(0),
+        m_error(0) {
+}
+
+ZipExtractor::~ZipExtractor() {
+    close();
+}
+
+int ZipExtractor::open(const QString& zipPath) {
+    close();
+
+    m_file.setFileName(zipPath);
+    if (!m_file.open(QIODevice::ReadOnly)) {  // flawfinder: ignore
+        qWarning() << "ZipExtractor: Could not open" << zipPath
+                   << m_file.errorString();
+        return 1;
+    }
+    m_mapSize = m_file.size();
+    m_map = m_file.map(0, m_mapSize);
+    if (m_map == nullptr) {
+        qWarning() << "ZipExtractor: Could not map" << zipPath
+                   << m_file.errorString();
+        close();
+        return 1;
+    }
+
+    mz_zip_archive zip;
+    (void)memset(&zip, 0, sizeof(zip));
+    if (!mz_zip_reader_init_mem(&zip, m_map, m_mapSize, 0)) {
+        qWarning() << "ZipExtractor: Not a zip file" << zipPath
+                   << mz_zip_get_error_string(mz_zip_get_last_error(&zip));
+        close();
+        return 1;
+    }
+
+    int status = 0;
+    const mz_uint numFiles = mz_zip_reader_get_num_files(&zip);
+    m_entries.reserve(numFiles);
+    for (mz_uint i = 0; i < numFiles; i++) {
+        mz_zip_archive_file_stat stat;
+        if (!mz_zip_reader_file_stat(&zip, i, &stat)) {
+            qWarning() << "ZipExtractor: Failed to get file info for file"
+                       << i << "in zip file" << zipPath;
+            status = 2;
+            break;
+        }
+
+        const QString name = QString::fromUtf8(stat.m_filename);
+        if (name.endsWith('/') == true) {
+            continue;  // Skip directories
+        }
+
+        const QString path = cleanEntryPath(name);
+        if (path.isEmpty()) {
+            qWarning() << "ZipExtractor: Entry outside the archive root"
+                       << name << "in zip file" << zipPath;
+            status = 2;
+            break;
+        }
+
+        m_entries.append({i, path, stat.m_comp_size, stat.m_uncomp_size,
+            static_cast<qint64>(stat.m_time)});
+        m_totalBytes += stat.m_uncomp_size;
+    }
+    mz_zip_reader_end(&zip);
+
+    if (status == 0) {
+        qDebug() << "Zip file contains" << m_entries.size() << "files,"
+                 << m_totalBytes << "bytes";
+    } else {
+        close();
+    }
+    return status;
+}
+
+QString ZipExtractor::cleanEntryPath(const QString& name) {
+    // Keep every entry inside the output directory
+    QString path = QDir::cleanPath(name);
+    if (path.isEmpty() || QDir::isAbsolutePath(path) || (path == "..") ||
+            path.startsWith("../")) {
+        path.clear();
+    }
+    return path;
+}
+
+void ZipExtractor::close() {
+    if (m_map != nullptr) {
+        (void)m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    m_file.close();
+    m_mapSize = 0;
+    m_entries.clear();
+    m_totalBytes = 0;
+}
+
+int ZipExtractor::extract(const QString& outputDir, int workers,
+        const std::function<void(quint64, quint64)>& progress) {
+    m_doneBytes = 0;
+    m_error = 0;
+
+    // Make the directories up front so the workers never race on mkpath
+    QSet<QString> dirs;
+    for (const Entry& entry : m_entries) {
+        const QString dir =
+            QFileInfo(QString("%1/%2").arg(outputDir, entry.path)).path();
+        if (!dirs.contains(dir)) {
+            if (!QDir().mkpath(dir)) {
+                qWarning() << "Failed to create directory" << dir;
+                return 3;
+            }
+            dirs.insert(dir);
+        }
+    }
+
+    // Longest processing time first: the largest entry goes to the worker
+    // with the least compressed bytes so far
+    const qint64 count = std::clamp<qint64>(workers, 1,
+        std::max<qint64>(m_entries.size(), 1));
+    QVector<qint64> order(m_entries.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](qint64 a, qint64 b) {
+        return m_entries[a].compressedSize > m_entries[b].compressedSize;
+    });
+    QVector<QVector<qint64>> buckets(count);
+    QVector<quint64> load(count, 0);
+    for (const qint64 i : order) {
+        const qint64 worker =
+            std::min_element(load.begin(), load.end()) - load.begin();
+        buckets[worker].append(i);
+        // Count the entry header too so empty files still spread out
+        load[worker] += m_entries[i].compressedSize + 1;
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(count);
+    for (const QVector<qint64>& bucket : buckets) {
+        if (!bucket.isEmpty()) {
+            pool.start([this, bucket, &outputDir]() {
+                runWorker(bucket, outputDir);
+            });
+        }
+    }
+    while (!pool.waitForDone(50)) {
+        if (progress) {
+            progress(m_doneBytes.load(), m_totalBytes);
+        }
+    }
+    if (progress) {
+        progress(m_doneBytes.load(), m_totalBytes);
+    }
+    return m_error.load();
+}
+
+void ZipExtractor::runWorker(const QVector<qint64>& entries,
+        const QString& outputDir) {
+    // Entries are read by index, the name lookup table is not needed
+    mz_zip_archive zip;
+    (void)memset(&zip, 0, sizeof(zip));
+    if (!mz_zip_reader_init_mem(&zip, m_map, m_mapSize,
+            MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY)) {
+        qWarning() << "ZipExtractor: Worker could not read"
+                   << m_file.fileName();
+        setError(4);
+        return;
+    }
+
+    for (const qint64 i : entries) {
+        if (m_error.load() != 0) {
+            break;
+        }
+        const Entry& entry = m_entries[i];
+        QFile file(QString("%1/%2").arg(outputDir, entry.path));
+        // Unlink first, never write through a link into the FileStore
+        (void)file.remove();
+        bool status = file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        if (status == true) {
+            EntryWriter writer = {&file, &m_doneBytes};
+            status = mz_zip_reader_extract_to_callback(
+                &zip, entry.index, writeEntry, &writer, 0);
+        }
+        if (status == true) {
+            (void)file.setFileTime(QDateTime::fromSecsSinceEpoch(entry.time),
+                QFileDevice::FileModificationTime);
+            file.close();
+        } else {
+            qWarning() << "Failed to extract file" << entry.path
+                       << "from zip file" << m_file.fileName()
+                       << mz_zip_get_error_string(mz_zip_get_last_error(&zip))
+                       << file.errorString();
+            setError(4);
+            break;
+        }
+    }
+    mz_zip_reader_end(&zip);
+}
+
+void ZipExtractor::setError(int error) {
+    int expected = 0;
+    (void)m_error.compare_exchange_strong(expected, error);
+}
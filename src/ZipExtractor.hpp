@@ -0,0 +1,111 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef SRC_ZIPEXTRACTOR_HPP_
+#define SRC_ZIPEXTRACTOR_HPP_
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+
+/**
+ * @class ZipExtractor
+ * @brief Extracts a ZIP archive with several worker threads.
+ *
+ * The archive is mapped read-only and its central directory read once in
+ * open(). extract() splits the file entries over the workers by compressed
+ * size, largest first to the least loaded worker, so one big audio track
+ * does not end up queued behind the rest. Each worker inflates from its own
+ * miniz reader over the shared mapping. Progress is counted in uncompressed
+ * bytes written, summed over all workers.
+ */
+class ZipExtractor {
+ public:
+    ZipExtractor();
+    ~ZipExtractor();
+
+    /**
+     * @brief Map the archive and read its central directory.
+     * @param zipPath Full path to the ZIP file.
+     * @return int Status code:
+     *         - 0: The archive is ready to extract.
+     *         - 1: Failed to open or map the archive.
+     *         - 2: Failed to read an entry of the central directory.
+     */
+    int open(const QString& zipPath);
+
+    /**
+     * @brief Unmap and close the archive.
+     */
+    void close();
+
+    /**
+     * @brief Extract every file entry under a directory.
+     *
+     * Blocks until all workers are done, calling the progress function on
+     * the calling thread while it waits and once more at the end.
+     *
+     * @param outputDir Existing directory to extract into.
+     * @param workers Number of worker threads, at most one per entry.
+     * @param progress Called with the bytes written so far and totalBytes().
+     * @return int Status code:
+     *         - 0: All entries extracted.
+     *         - 3: Failed to create a directory.
+     *         - 4: Failed to extract an entry.
+     */
+    int extract(const QString& outputDir, int workers,
+            const std::function<void(quint64, quint64)>& progress = nullptr);
+
+    /**
+     * @brief Relative output path of an archive entry.
+     * @param name Entry name from the archive.
+     * @return The cleaned path, empty if it would land outside the output
+     *         directory.
+     */
+    static QString cleanEntryPath(const QString& name);
+
+    qint64 entryCount() const { return m_entries.size(); }
+    quint64 totalBytes() const { return m_totalBytes; }
+    quint64 doneBytes() const { return m_doneBytes.load(); }
+
+ private:
+    /**
+     * @struct Entry
+     * @brief A file entry from the central directory.
+     */
+    struct Entry {
+        quint32 index;
+        QString path;
+        quint64 compressedSize;
+        quint64 size;
+        qint64 time;
+    };
+
+    void runWorker(const QVector<qint64>& entries, const QString& outputDir);
+    void setError(int error);
+
+    QFile m_file;
+    uchar* m_map;
+    qint64 m_mapSize;
+    QVector<Entry> m_entries;
+    quint64 m_totalBytes;
+    std::atomic<quint64> m_doneBytes;
+    std::atomic<int> m_error;
+
+    Q_DISABLE_COPY(ZipExtractor)
+};
+
+#endif  // SRC_ZIPEXTRACTOR_HPP_
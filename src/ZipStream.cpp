@@ -0,0 +1,336 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "../src/ZipStream.hpp"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include "../miniz/miniz.h"  // IWYU pragma: keep
+#include "../src/ZipExtractor.hpp"
+
+namespace {
+
+constexpr quint32 localHeaderSignature = 0x04034b50;
+constexpr quint32 centralHeaderSignature = 0x02014b50;
+constexpr quint32 endOfCentralSignature = 0x06054b50;
+constexpr quint32 descriptorSignature = 0x08074b50;
+constexpr qint64 localHeaderSize = 30;
+
+constexpr quint16 flagEncrypted = 0x0001;
+constexpr quint16 flagDescriptor = 0x0008;
+constexpr quint16 methodStored = 0;
+constexpr quint16 methodDeflated = 8;
+
+quint16 le16(const char* p) {
+    return qFromLittleEndian<quint16>(p);
+}
+
+quint32 le32(const char* p) {
+    return qFromLittleEndian<quint32>(p);
+}
+
+quint64 le64(const char* p) {
+    return qFromLittleEndian<quint64>(p);
+}
+
+}  // namespace
+
+/**
+ * @struct ZipStream::Inflater
+ * @brief Raw deflate state of the entry being extracted.
+ */
+struct ZipStream::Inflater {
+    mz_stream stream;
+    char out[64 * 1024];
+
+    Inflater() {
+        (void)memset(&stream, 0, sizeof(stream));
+        (void)mz_inflateInit2(&stream, -MZ_DEFAULT_WINDOW_BITS);
+    }
+
+    ~Inflater() {
+        (void)mz_inflateEnd(&stream);
+    }
+};
+
+ZipStream::ZipStream(const QString& outputDir) :
+        m_outputDir(outputDir),
+        m_state(State::Header),
+        m_entry(),
+        m_crc(MZ_CRC32_INIT),
+        m_remaining(0),
+        m_madeOutput(false),
+        m_entryCount(0),
+        m_bytesWritten(0) {
+}
+
+ZipStream::~ZipStream() {
+    m_file.close();
+}
+
+bool ZipStream::feed(const char* data, qint64 size) {
+    if ((m_state == State::Done) || (m_state == State::Fallback) ||
+            (m_state == State::Failed)) {
+        return m_state != State::Failed;
+    }
+
+    m_buffer.append(data, size);
+    qint64 pos = 0;
+    bool more = true;
+    while (more == true) {
+        switch (m_state) {
+        case State::Header:     more = readHeader(&pos);     break;
+        case State::Data:       more = readData(&pos);       break;
+        case State::Descriptor: more = readDescriptor(&pos); break;
+        default:                more = false;                break;
+        }
+    }
+
+    if ((m_state == State::Header) || (m_state == State::Data) ||
+            (m_state == State::Descriptor)) {
+        m_buffer.remove(0, pos);
+    } else {
+        m_buffer.clear();
+    }
+    return m_state != State::Failed;
+}
+
+bool ZipStream::readHeader(qint64* pos) {
+    const qint64 avail = m_buffer.size() - *pos;
+    const char* p = m_buffer.constData() + *pos;
+    if (avail < 4) {
+        return false;
+    }
+
+    const quint32 signature = le32(p);
+    if ((signature == centralHeaderSignature) ||
+            (signature == endOfCentralSignature)) {
+        m_state = State::Done;
+        qDebug() << "ZipStream: Extracted" << m_entryCount << "files,"
+                 << m_bytesWritten << "bytes while downloading";
+        return false;
+    }
+    if (signature != localHeaderSignature) {
+        stop(State::Fallback, "no local file header");
+        return false;
+    }
+    if (avail < localHeaderSize) {
+        return false;
+    }
+
+    const quint16 nameSize = le16(p + 26);
+    const quint16 extraSize = le16(p + 28);
+    if (avail < localHeaderSize + nameSize + extraSize) {
+        return false;
+    }
+
+    m_entry.flags = le16(p + 6);
+    m_entry.method = le16(p + 8);
+    m_entry.time = le16(p + 10);
+    m_entry.date = le16(p + 12);
+    m_entry.crc = le32(p + 14);
+    m_entry.compressedSize = le32(p + 18);
+    m_entry.zip64 = false;
+    const QString name =
+        QString::fromUtf8(p + localHeaderSize, nameSize);
+
+    // Zip64 extra field: uncompressed then compressed size, 8 bytes each
+    const char* extra = p + localHeaderSize + nameSize;
+    for (qint64 i = 0; i + 4 <= extraSize;) {
+        const quint16 id = le16(extra + i);
+        const quint16 size = le16(extra + i + 2);
+        if ((id == 0x0001) && (size >= 16) && (i + 4 + size <= extraSize)) {
+            m_entry.zip64 = true;
+            m_entry.compressedSize = le64(extra + i + 12);
+        }
+        i += 4 + size;
+    }
+    *pos += localHeaderSize + nameSize + extraSize;
+
+    m_entry.path = ZipExtractor::cleanEntryPath(name);
+    if ((m_entry.flags & flagEncrypted) != 0) {
+        stop(State::Fallback, "encrypted entry " + name);
+    } else if ((m_entry.method != methodStored) &&
+            (m_entry.method != methodDeflated)) {
+        stop(State::Fallback,
+            QString("compression method %1").arg(m_entry.method));
+    } else if ((m_entry.method == methodStored) &&
+            ((m_entry.flags & flagDescriptor) != 0)) {
+        stop(State::Fallback, "stored entry of unknown size " + name);
+    } else if (m_entry.path.isEmpty()) {
+        stop(State::Fallback, "entry outside the archive root " + name);
+    } else if (openEntry(name.endsWith('/')) == true) {
+        m_state = State::Data;
+    }
+    return m_state == State::Data;
+}
+
+bool ZipStream::openEntry(bool directory) {
+    m_crc = MZ_CRC32_INIT;
+    m_remaining = m_entry.compressedSize;
+    m_madeOutput = true;
+
+    const QString filePath = QString("%1/%2").arg(m_outputDir, m_entry.path);
+    const QString dir = directory ? filePath : QFileInfo(filePath).path();
+    if (!m_dirs.contains(dir)) {
+        if (!QDir().mkpath(dir)) {
+            stop(State::Failed, "could not create directory " + dir);
+            return false;
+        }
+        m_dirs.insert(dir);
+    }
+
+    if (directory == false) {
+        m_file.setFileName(filePath);
+        // Unlink first, never write through a link into the FileStore
+        (void)m_file.remove();
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            stop(State::Failed, "could not write " + filePath + " " +
+                m_file.errorString());
+            return false;
+        }
+    }
+    if (m_entry.method == methodDeflated) {
+        m_inflater = std::make_unique<Inflater>();
+    }
+    return true;
+}
+
+bool ZipStream::writeEntry(const char* data, qint64 size) {
+    m_crc = static_cast<quint32>(mz_crc32(m_crc,
+        reinterpret_cast<const unsigned char*>(data), size));
+    if (m_file.isOpen() && (m_file.write(data, size) != size)) {
+        stop(State::Failed, "could not write " + m_file.fileName() + " " +
+            m_file.errorString());
+        return false;
+    }
+    m_bytesWritten += size;
+    return true;
+}
+
+bool ZipStream::readData(qint64* pos) {
+    const qint64 avail = m_buffer.size() - *pos;
+    const char* p = m_buffer.constData() + *pos;
+
+    if (m_entry.method == methodStored) {
+        const qint64 size = static_cast<qint64>(
+            std::min<quint64>(avail, m_remaining));
+        if ((size > 0) && (writeEntry(p, size) == false)) {
+            return false;
+        }
+        *pos += size;
+        m_remaining -= size;
+        if (m_remaining == 0) {
+            finishData();
+        }
+        return m_state != State::Data;
+    }
+
+    if (avail == 0) {
+        return false;
+    }
+    mz_stream& stream = m_inflater->stream;
+    stream.next_in = reinterpret_cast<const unsigned char*>(p);
+    stream.avail_in = static_cast<unsigned int>(
+        std::min<qint64>(avail, 1 << 30));
+    while (true) {
+        stream.next_out = reinterpret_cast<unsigned char*>(m_inflater->out);
+        stream.avail_out = sizeof(m_inflater->out);
+        const int ret = mz_inflate(&stream, MZ_NO_FLUSH);
+        const qint64 produced = sizeof(m_inflater->out) - stream.avail_out;
+        if ((produced > 0) &&
+                (writeEntry(m_inflater->out, produced) == false)) {
+            return false;
+        }
+        if (ret == MZ_STREAM_END) {
+            // The deflate stream ends itself, what's left is the next record
+            *pos += avail - stream.avail_in;
+            m_inflater.reset();
+            finishData();
+            return m_state != State::Data;
+        }
+        if ((ret != MZ_OK) && (ret != MZ_BUF_ERROR)) {
+            stop(State::Failed, "corrupt deflate data in " + m_entry.path);
+            return false;
+        }
+        if ((ret == MZ_BUF_ERROR) ||
+                ((stream.avail_in == 0) && (stream.avail_out != 0))) {
+            break;
+        }
+    }
+    *pos += avail - stream.avail_in;
+    return false;
+}
+
+void ZipStream::finishData() {
+    if ((m_entry.flags & flagDescriptor) != 0) {
+        m_state = State::Descriptor;
+    } else {
+        closeEntry(m_entry.crc);
+    }
+}
+
+bool ZipStream::readDescriptor(qint64* pos) {
+    const qint64 avail = m_buffer.size() - *pos;
+    const char* p = m_buffer.constData() + *pos;
+    if (avail < 4) {
+        return false;
+    }
+
+    // CRC and both sizes, after an optional signature
+    const qint64 skip = (le32(p) == descriptorSignature) ? 4 : 0;
+    const qint64 size = skip + 4 + (m_entry.zip64 ? 16 : 8);
+    if (avail < size) {
+        return false;
+    }
+    *pos += size;
+    closeEntry(le32(p + skip));
+    return m_state == State::Header;
+}
+
+void ZipStream::closeEntry(quint32 crc) {
+    if (m_crc != crc) {
+        stop(State::Failed, "CRC mismatch in " + m_entry.path);
+        return;
+    }
+    if (m_file.isOpen()) {
+        const QDateTime time(
+            QDate(1980 + (m_entry.date >> 9), (m_entry.date >> 5) & 0x0f,
+                m_entry.date & 0x1f),
+            QTime(m_entry.time >> 11, (m_entry.time >> 5) & 0x3f,
+                (m_entry.time & 0x1f) * 2));
+        (void)m_file.setFileTime(time, QFileDevice::FileModificationTime);
+        m_file.close();
+        m_entryCount++;
+    }
+    m_state = State::Header;
+}
+
+void ZipStream::stop(State state, const QString& reason) {
+    if (m_file.isOpen()) {
+        m_file.close();
+        (void)m_file.remove();
+    }
+    m_inflater.reset();
+    m_state = state;
+    if (state == State::Failed) {
+        qWarning() << "ZipStream: Extraction failed," << reason;
+    } else {
+        qDebug() << "ZipStream: Extracting from the central directory,"
+                 << reason;
+    }
+}
@@ -0,0 +1,112 @@
+/* TombRaiderLinuxLauncher
+ * Martin Bångens Copyright (C) 2025
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef SRC_ZIPSTREAM_HPP_
+#define SRC_ZIPSTREAM_HPP_
+
+#include <QByteArray>
+#include <QFile>
+#include <QSet>
+#include <QString>
+
+#include <memory>
+
+/**
+ * @class ZipStream
+ * @brief Extracts a ZIP archive from its bytes in download order.
+ *
+ * The archive is parsed from the front, local file header by local file
+ * header, and each stored or deflated entry is written out as its bytes
+ * arrive. The CRC of every entry is checked against its header or data
+ * descriptor. Parsing stops at the central directory.
+ *
+ * Some archives can't be read this way: encrypted entries, other
+ * compression methods, stored entries with a data descriptor and anything
+ * in front of the first local header. The stream then falls back, stops
+ * extracting and the caller extracts the saved archive through its
+ * central directory with ZipExtractor.
+ */
+class ZipStream {
+ public:
+    /**
+     * @param outputDir Directory to extract into, made on the first entry.
+     */
+    explicit ZipStream(const QString& outputDir);
+    ~ZipStream();
+
+    /**
+     * @brief Parse the next bytes of the archive.
+     * @param data Bytes following the ones fed before.
+     * @param size Number of bytes.
+     * @return `false` if the archive is broken or an entry can't be written.
+     */
+    bool feed(const char* data, qint64 size);
+
+    /**
+     * @brief The central directory was reached with every entry extracted.
+     */
+    bool isComplete() const { return m_state == State::Done; }
+
+    /**
+     * @brief Something was written to the output directory.
+     */
+    bool hasOutput() const { return m_madeOutput; }
+
+    qint64 entryCount() const { return m_entryCount; }
+    quint64 bytesWritten() const { return m_bytesWritten; }
+
+ private:
+    enum class State { Header, Data, Descriptor, Done, Fallback, Failed };
+
+    /**
+     * @struct Entry
+     * @brief The local file header of the entry being extracted.
+     */
+    struct Entry {
+        QString path;
+        quint16 flags;
+        quint16 method;
+        quint16 time;
+        quint16 date;
+        quint32 crc;
+        quint64 compressedSize;
+        bool zip64;
+    };
+
+    bool readHeader(qint64* pos);
+    bool readData(qint64* pos);
+    bool readDescriptor(qint64* pos);
+    bool openEntry(bool directory);
+    bool writeEntry(const char* data, qint64 size);
+    void finishData();
+    void closeEntry(quint32 crc);
+    void stop(State state, const QString& reason);
+
+    QString m_outputDir;
+    QByteArray m_buffer;
+    State m_state;
+    Entry m_entry;
+    QFile m_file;
+    quint32 m_crc;
+    quint64 m_remaining;
+    struct Inflater;
+    std::unique_ptr<Inflater> m_inflater;
+    QSet<QString> m_dirs;
+    bool m_madeOutput;
+    qint64 m_entryCount;
+    quint64 m_bytesWritten;
+
+    Q_DISABLE_COPY(ZipStream)
+};
+
+#endif  // SRC_ZIPSTREAM_HPP_
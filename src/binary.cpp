@@ -20,6 +20,7 @@
 #include <string>
 #include <LIEF/PE.hpp>
 #include "../src/Path.hpp"
+#include "../src/FileStore.hpp"
 
 QString decideExe(const QDir& dir) {
     QString fileName;
@@ -288,8 +289,11 @@ qint64 findReplacePattern(QFile* const file) {
         // Replace the pattern
         fileContent.replace(index, pattern.size(), replacement);
 
-        // Reopen the file for writing
-        if (!file->open(QIODevice::WriteOnly)) {  // flawfinder: ignore
+        // Reopen the file for writing, off any shared store object
+        if (!FileStore::breakLink(file->fileName())) {
+            qCritical() << "Error making the file writable!";
+            status = 2;
+        } else if (!file->open(QIODevice::WriteOnly)) {  // flawfinder: ignore
             qCritical() << "Error opening file for writing!";
             status = 2;
         } else if (file->write(fileContent) == -1) {
@@ -36,6 +36,7 @@ struct RunnerOptions {
     quint64 id = 0;
     quint64 steamID = 0;
     quint64 command = 0;
+    quint64 type = 0;  ///< Game type, looked up before the runner starts
     QString winePath;
     QList<QPair<QString, QString>> envList;
     QStringList arguments;
@@ -13,6 +13,7 @@
 
 #include <QtGlobal>
 #include "../src/CommandLineParser.hpp"
+#include "../src/QueryStats.hpp"
 #ifdef TEST
 #include <QCoreApplication>
 #include <QTest>
@@ -42,6 +43,51 @@ int main(int argc, char *argv[]) {
         status = QTest::qExec(&test, app.arguments());
     }
 
+    if (status == 0) {
+        DataQueryPlanTest queryPlanTest;
+        status = QTest::qExec(&queryPlanTest, app.arguments());
+    }
+
+    if (status == 0) {
+        LevelCatalogTest levelCatalogTest;
+        status = QTest::qExec(&levelCatalogTest, app.arguments());
+    }
+
+    if (status == 0) {
+        ZipExtractorTest zipExtractorTest;
+        status = QTest::qExec(&zipExtractorTest, app.arguments());
+    }
+
+    if (status == 0) {
+        HashCopyTest hashCopyTest;
+        status = QTest::qExec(&hashCopyTest, app.arguments());
+    }
+
+    if (status == 0) {
+        FileStoreTest fileStoreTest;
+        status = QTest::qExec(&fileStoreTest, app.arguments());
+    }
+
+    if (status == 0) {
+        FileHashTest fileHashTest;
+        status = QTest::qExec(&fileHashTest, app.arguments());
+    }
+
+    if (status == 0) {
+        ProgressTest progressTest;
+        status = QTest::qExec(&progressTest, app.arguments());
+    }
+
+    if (status == 0) {
+        TrashReaperTest trashReaperTest;
+        status = QTest::qExec(&trashReaperTest, app.arguments());
+    }
+
+    if (status == 0) {
+        SaveStoreTest saveStoreTest;
+        status = QTest::qExec(&saveStoreTest, app.arguments());
+    }
+
     return status;  // Exit after handling the custom flag
 }
 #else
@@ -73,6 +119,11 @@ int main(int argc, char *argv[]) {
             }
             status = app.exec();
         }
+
+        if (!startupSetting.queryStatsPath.isEmpty()) {
+            (void)QueryStats::getInstance().writeJson(
+                startupSetting.queryStatsPath);
+        }
     }
 
     return status;
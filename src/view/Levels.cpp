@@ -1,5 +1,7 @@
 #include "view/Levels.hpp"
 #include "view/Levels/Select/StackedWidgetBar.hpp"
+#include "../src/Progress.hpp"
+#include <QDateTime>
 #include <qabstractitemview.h>
 #include <qapplication.h>
 #include <qcheckbox.h>
@@ -23,6 +25,9 @@ UiLevels::UiLevels(QWidget *parent)
     loading(new Loading(stackedWidget)),
     select(new Select(stackedWidget)),
     m_listSet(false),
+    m_listFirstPage(true),
+    m_coversLoading(false),
+    m_infoId(0),
     m_wasDownloading(false),
     m_wasDownloadingTimes(0)
 {
@@ -109,13 +114,30 @@ UiLevels::UiLevels(QWidget *parent)
     connect(&Controller::getInstance(), &Controller::controllerReloadLevelList,
             this, &UiLevels::loadMoreCovers);
 
+    // Arrive with the next decoded Info screenshot, in order
+    connect(&Controller::getInstance(), &Controller::controllerInfoImage,
+            this, &UiLevels::infoImage);
+
+    // Arrive with next page of level cards
+    connect(&Controller::getInstance(), &Controller::controllerListPage,
+            this, &UiLevels::listPage);
+
+    // Restart the cover loading when new cards are shown
+    connect(select, &Select::levelsInserted, this, [this]() {
+        if (!m_coversLoading) {
+            loadMoreCovers();
+        }
+    });
+
     // Thread work done signal connections
     connect(&Controller::getInstance(), &Controller::controllerGenerateList,
             this, &UiLevels::generateList);
 
-    // Progress bar signal connection
-    connect(&Controller::getInstance(), &Controller::controllerTickSignal,
-            this, &UiLevels::workTick);
+    // Progress bar, the workers only publish it
+    m_progressTimer = new QTimer(this);
+    m_progressTimer->setInterval(16);
+    connect(m_progressTimer, &QTimer::timeout,
+            this, &UiLevels::progressSample);
 
     // Error signal connections
     connect(&Controller::getInstance(), &Controller::controllerDownloadError,
@@ -132,6 +154,17 @@ UiLevels::UiLevels(QWidget *parent)
     connect(&Controller::getInstance(), &Controller::controllerRunningDone,
             this, &UiLevels::runningLevelDone);
 
+    // Removed levels are deleted in the background
+    connect(&Controller::getInstance(), &Controller::controllerSpaceFreed,
+            this, &UiLevels::spaceFreed);
+    m_spaceFreedTimer = new QTimer(this);
+    m_spaceFreedTimer->setSingleShot(true);
+    m_spaceFreedTimer->setInterval(10000);
+    connect(m_spaceFreedTimer, &QTimer::timeout, this, [this]() {
+        m_spaceFreed = 0;
+        select->stackedWidgetBar->navigateWidgetBar->labelStatus->clear();
+    });
+
     // Buttons
     connect(this->info->infoBar->pushButtonBack, &QPushButton::clicked,
             this, &UiLevels::backClicked);
@@ -145,9 +178,43 @@ UiLevels::UiLevels(QWidget *parent)
 
     connect(this->select->stackedWidgetBar->navigateWidgetBar->pushButtonRun,
             &QPushButton::clicked, this, &UiLevels::runClicked);
+
+    FilterGroupBoxSearch* filterGroupBoxSearch =
+        select->filter->filterFirstInputRow->filterGroupBoxSearch;
+    connect(filterGroupBoxSearch->comboBoxSearch,
+            &QComboBox::currentIndexChanged,
+            this, &UiLevels::searchChanged);
+    connect(filterGroupBoxSearch->lineEditSearch,
+            &QLineEdit::textChanged,
+            this, &UiLevels::searchChanged);
+}
+
+void UiLevels::searchChanged() {
+    FilterGroupBoxSearch* filterGroupBoxSearch =
+        select->filter->filterFirstInputRow->filterGroupBoxSearch;
+    const QString text = filterGroupBoxSearch->lineEditSearch->text();
+    const qint64 scope = filterGroupBoxSearch->comboBoxSearch->currentIndex();
+    if (text.trimmed().isEmpty()) {
+        m_searchText.clear();
+        select->setSearchResult(false, QSet<quint64>());
+    } else {
+        m_searchText = text;
+        controller.searchLevels(text, scope).then(this,
+                [this, text](const QVector<qint64>& result) {
+            // Only the answer to the latest text is used
+            if (text == m_searchText) {
+                QSet<quint64> lids;
+                for (const qint64 lid : result) {
+                    lids.insert(static_cast<quint64>(lid));
+                }
+                select->setSearchResult(true, lids);
+            }
+        });
+    }
 }
 
 void UiLevels::downloadError(int status) {
+    m_progressTimer->stop();
     select->downloadingState(true);
     select->stackedWidgetBar->progressWidgetBar->progressBar->setValue(0);
     select->setCurrentWidgetBar(StackedWidgetBar::Navigate);
@@ -192,6 +259,7 @@ void UiLevels::downloadError(int status) {
 }
 
 void UiLevels::fileError(int status) {
+    m_progressTimer->stop();
     select->downloadingState(true);
     select->stackedWidgetBar->progressWidgetBar->progressBar->setValue(0);
     select->setCurrentWidgetBar(StackedWidgetBar::Navigate);
@@ -259,9 +327,28 @@ void Loading::hide() {
 void UiLevels::callbackDialog(QString selected) {
     const quint64 lid = select->getLid();
 
+    if (selected == "Restore saves") {
+        controller.getSaveSnapshots(lid).then(this,
+                [this](const QVector<qint64>& snapshots) {
+            showRestoreDialog(snapshots);
+        });
+        return;
+    }
+    if (m_restoreOptions.contains(selected)) {
+        const qint64 snapshot = m_restoreOptions.value(selected);
+        controller.restoreSaveSnapshot(lid, snapshot).then(this,
+                [snapshot](bool status) {
+            if (!status) {
+                qWarning() << "Could not restore all saves of snapshot"
+                           << snapshot;
+            }
+        });
+    }
+    m_restoreOptions.clear();
+
     if (selected == "Remove Level and zip files" ||
             selected == "Remove zip file") {
-        controller.deleteZip(lid);
+        (void)controller.deleteZip(lid);
     }
     if (selected == "Remove Level and zip files" ||
             selected == "Remove just Level files") {
@@ -312,6 +399,9 @@ void UiLevels::setItemChanged(const QModelIndex &current) {
     qint64 id = select->getLid();
     qDebug() << "setItemChanged id:" << id;
     levelDirSelected(id);
+    // Warm the Info pages of the selection and the cards around it
+    controller.prefetchLevels(select->getNeighbourLids(current, 2),
+            m_screenSize);
 }
 
 
@@ -356,36 +446,52 @@ void UiLevels::setSortMode(LevelListProxy::SortMode mode) {
 
 void UiLevels::setList() {
     m_listSet = true;
-    QVector<QSharedPointer<ListItemData>> list;
-    controller.getList(&list);
-    InstalledStatus installedStatus = getInstalled();
+    m_listFirstPage = true;
+    m_installedStatus = getInstalled();
+    controller.getList();
+}
 
-    for (const auto &item : list) {
+void UiLevels::listPage(
+        QVector<QSharedPointer<ListItemData>> page, bool last) {
+    for (const auto &item : page) {
         Q_ASSERT(item != nullptr);
-        bool trle = installedStatus.trle.value(item->m_trle_id, false);
+        bool trle = m_installedStatus.trle.value(item->m_trle_id, false);
         item->m_installed = trle;
     }
 
-    select->setLevels(list);
-
-    // Select the first item
-    QModelIndex firstIndex = select->levelViewList->model()->index(0, 0);
-    if (firstIndex.isValid()) {
-        select->levelViewList->selectionModel()->setCurrentIndex(
-            firstIndex,
-            QItemSelectionModel::Select | QItemSelectionModel::Current
-        );
-
+    if (m_listFirstPage == true) {
+        m_listFirstPage = false;
+        select->setLevels(page);
+
+        // Select the first item
+        QModelIndex firstIndex = select->levelViewList->model()->index(0, 0);
+        if (firstIndex.isValid()) {
+            select->levelViewList->selectionModel()->setCurrentIndex(
+                firstIndex,
+                QItemSelectionModel::Select | QItemSelectionModel::Current
+            );
+        }
+        loadMoreCovers();
+    } else {
+        // The view fetches pages as it scrolls, the last page flushes
+        // the rest so filters and sorting see the whole catalog
+        select->appendLevels(page, last);
     }
-    loadMoreCovers();
 }
 
 void UiLevels::loadMoreCovers() {
-    if (!select->stop()) {
+    // Move the covers of the last batch into the level catalog
+    select->takeCovers();
+    m_coversLoading = false;
+    while (!m_coversLoading && !select->stop()) {
         QVector<QSharedPointer<ListItemData>> buffer =
                 select->getDataBuffer(20);
         if (!buffer.isEmpty()) {
             controller.getCoverList(buffer);
+            m_coversLoading = true;
+        } else {
+            // Every card in this chunk already has a cover
+            select->reset();
         }
     }
     static bool firstTime = true;
@@ -400,35 +506,46 @@ void UiLevels::loadMoreCovers() {
 void UiLevels::infoClicked() {
     qint64 id = select->getLid();
     if (id != 0) {
-        InfoData info = controller.getInfo(id);
-        if (info.m_body == "" && info.m_imageList.size() == 0) {
-            loading->show();
-            stackedWidget->setCurrentWidget(
-                    stackedWidget->findChild<QWidget*>("loading"));
-            controller.updateLevel(id);
-            m_loadingDoneGoTo = "info";
-            return;
-        }
-
-        this->info->infoContent->infoWebEngineView->setHtml(info.m_body);
+        controller.getLevelDetail(id).then(this,
+                [this, id](const LevelDetail& detail) {
+            showInfo(id, detail);
+        });
+    }
+}
 
-        QListWidget *coverListWidget = this->info->infoContent->coverListWidget;
-        coverListWidget->clear();
-        for (int i = 0; i < info.m_imageList.size(); ++i) {
-            const QIcon &icon = info.m_imageList.at(i);
-            QListWidgetItem *item = new QListWidgetItem(icon, "");
-            item->setSizeHint(QSize(502, 377));
-            coverListWidget->addItem(item);
-        }
-        this->info->infoContent->infoWebEngineView->show();
+void UiLevels::showInfo(qint64 id, const LevelDetail& detail) {
+    const InfoData& info = detail.info;
+    if (id != select->getLid()) {
+        // The selection moved on while the query ran
+        return;
+    }
+    if (info.m_body == "" && info.m_imageData.size() == 0) {
+        loading->show();
         stackedWidget->setCurrentWidget(
-                stackedWidget->findChild<QWidget*>("info"));
-        if (controller.getWalkthrough(id) != "") {
-            this->info->infoBar->pushButtonWalkthrough->setEnabled(true);
-        } else {
-            this->info->infoBar->pushButtonWalkthrough->setEnabled(false);
+                stackedWidget->findChild<QWidget*>("loading"));
+        controller.updateLevel(id);
+        m_loadingDoneGoTo = "info";
+        return;
+    }
+
+    this->info->infoContent->infoWebEngineView->setHtml(info.m_body);
+
+    this->info->infoContent->coverListWidget->clear();
+    m_infoId = id;
+    if (detail.hasScreens()) {
+        // Prefetched, no decoding needed
+        for (const QImage& screen : detail.screens) {
+            infoImage(id, screen);
         }
+    } else {
+        // The screens are decoded on the pool and arrive in infoImage()
+        controller.getInfoImages(id, info.m_imageData, m_screenSize);
     }
+    this->info->infoContent->infoWebEngineView->show();
+    stackedWidget->setCurrentWidget(
+            stackedWidget->findChild<QWidget*>("info"));
+    this->info->infoBar->pushButtonWalkthrough->setEnabled(
+            detail.hasWalkthrough());
 }
 
 void UiLevels::setStartupSetting(const StartupSetting startupSetting) {
@@ -484,6 +601,15 @@ void UiLevels::setStartupSetting(const StartupSetting startupSetting) {
     }
 }
 
+void UiLevels::infoImage(qint64 id, QImage image) {
+    if ((id == m_infoId) && !image.isNull()) {
+        QListWidgetItem *item =
+            new QListWidgetItem(QIcon(QPixmap::fromImage(image)), "");
+        item->setSizeHint(m_screenSize);
+        this->info->infoContent->coverListWidget->addItem(item);
+    }
+}
+
 void UiLevels::walkthroughClicked() {
     qint64 id = select->getLid();
     if (id != 0) {
@@ -492,8 +618,11 @@ void UiLevels::walkthroughClicked() {
 
         this->info->infoContent->coverListWidget->hide();
         this->info->infoBar->pushButtonWalkthrough->hide();
-        w->setHtml(controller.getWalkthrough(id));
-        w->show();
+        controller.getWalkthrough(id).then(this,
+                [w](const QString& walkthrough) {
+            w->setHtml(walkthrough);
+            w->show();
+        });
     }
 }
 
@@ -511,12 +640,15 @@ void UiLevels::updateLevelDone() {
     } else if (m_loadingDoneGoTo == "info") {
         qint64 id = select->getLid();
         if (id != 0) {
-            InfoData info = controller.getInfo(id);
-            if (!(info.m_body == "" && info.m_imageList.size() == 0)) {
-                infoClicked();
-            } else {
-                setStackedWidget("select");
-            }
+            controller.getLevelDetail(id).then(this,
+                    [this, id](const LevelDetail& detail) {
+                const InfoData& info = detail.info;
+                if (!(info.m_body == "" && info.m_imageData.size() == 0)) {
+                    showInfo(id, detail);
+                } else {
+                    setStackedWidget("select");
+                }
+            });
         }
     } else {
         qDebug() << "Forgot to set m_loadingDoneGoTo?";
@@ -524,27 +656,63 @@ void UiLevels::updateLevelDone() {
 }
 
 void UiLevels::removeClicked(qint64 id) {
-    // TODO: add the ability to remove the level without its save files
-    if (controller.checkZip(id)) {
+    controller.checkZip(id).then(this, [this](bool haveZip) {
+        showRemoveDialog(haveZip);
+    });
+}
+
+void UiLevels::showRemoveDialog(bool haveZip) {
+    if (haveZip) {
         QString text(
             "Select what you want to remove.\n"
-            "If you remove the level now you remove the level save files.\n"
+            "Snapshots of the save files are kept, they can be restored\n"
+            "once the level is installed again.\n"
         );
         dialog->setMessage(text);
         dialog->setOptions(QStringList()
                 << "Remove Level and zip files"
                 << "Remove just Level files"
-                << "Remove zip file");
+                << "Remove zip file"
+                << "Restore saves");
     } else {
         QString text(
-            "Select OK select to continue to remove level.\n"
-            "If you remove the level now you remove the level save files.\n"
+            "Select what you want to remove.\n"
+            "Snapshots of the save files are kept, they can be restored\n"
+            "once the level is installed again.\n"
         );
         dialog->setMessage(text);
         dialog->setOptions(QStringList()
-                << "Remove just Level files");
+                << "Remove just Level files"
+                << "Restore saves");
+    }
+
+    this->setStackedWidget("dialog");
+}
+
+void UiLevels::showRestoreDialog(const QVector<qint64>& snapshots) {
+    m_restoreOptions.clear();
+    QStringList options;
+    // Newest first, the current saves are snapshot before a restore.
+    // Snapshots can share a second, the ids are in milliseconds
+    for (qint64 i = snapshots.size() - 1; i >= 0; i--) {
+        const QString text = QDateTime::fromMSecsSinceEpoch(snapshots[i])
+                .toString("yyyy-MM-dd hh:mm:ss.zzz");
+        m_restoreOptions.insert(text, snapshots[i]);
+        options << text;
     }
 
+    if (options.isEmpty()) {
+        dialog->setMessage("There are no save snapshots of this level yet.");
+    } else if (options.size() == 1) {
+        dialog->setMessage(QString(
+            "Restore the saves from %1?\n"
+            "Save files made after them are kept.\n").arg(options.at(0)));
+    } else {
+        dialog->setMessage(
+            "Select the saves to restore.\n"
+            "Save files made after them are kept.\n");
+    }
+    dialog->setOptions(options);
     this->setStackedWidget("dialog");
 }
 
@@ -557,6 +725,7 @@ void UiLevels::downloadClicked(qint64 id) {
     select->downloadingState(false);
     select->stackedWidgetBar->progressWidgetBar->progressBar->setValue(0);
     select->setCurrentWidgetBar(StackedWidgetBar::Progress);
+    m_progressTimer->start();
 }
 
 void UiLevels::setpushButtonRunText(const QString &text) {
@@ -572,15 +741,32 @@ void UiLevels::setupGameOrLevel(qint64 id) {
     }
 }
 
-void UiLevels::workTick() {
-    int value = this->select->stackedWidgetBar->progressWidgetBar->
-        progressBar->value();
-    this->select->stackedWidgetBar->progressWidgetBar->
-        progressBar->setValue(value + 1);
-    qDebug() << this->select->stackedWidgetBar->
-        progressWidgetBar->progressBar->value() << "%";
-    if (this->select->stackedWidgetBar->
-            progressWidgetBar->progressBar->value() >= 100) {
+void UiLevels::progressSample() {
+    const Progress::Sample sample = Progress::getInstance().sample();
+    QProgressBar* progressBar =
+        this->select->stackedWidgetBar->progressWidgetBar->progressBar;
+    if (sample.bytesPerSecond > 0) {
+        progressBar->setFormat(QString("%p% %1 MiB/s").arg(
+            static_cast<double>(sample.bytesPerSecond) / (1024 * 1024),
+            0, 'f', 1));
+    } else {
+        progressBar->setFormat("%p%");
+    }
+    // Never step back when the next phase starts
+    if (sample.permille > progressBar->value()) {
+        progressBar->setValue(sample.permille);
+    }
+
+    if (sample.phase == Progress::Phase::Failed) {
+        // The error signal shows why, if there is one
+        m_progressTimer->stop();
+        progressBar->setValue(0);
+        select->setCurrentWidgetBar(StackedWidgetBar::Navigate);
+        select->downloadingState(true);
+    } else if (sample.phase == Progress::Phase::Done) {
+        m_progressTimer->stop();
+        progressBar->setFormat("%p%");
+        qDebug() << "Install done";
         qint64 id = select->getLid();
         select->setInstalledLevel();
         if (select->getType()) {
@@ -662,34 +848,42 @@ void UiLevels::runClicked() {
                 options.arguments = parsToArg(input);
                 controller.run(options);
             } else if (type == 3) {
-                if (!controller.link(id)) {
-                    qDebug() << "link error";
-                    runningLevelDone();
-                } else {
-                    options.id = id;
-                    options.command = LUTRIS;
-                    options.arguments = parsToArg(input);
-                    controller.run(options);
-                }
+                options.id = id;
+                options.command = LUTRIS;
+                options.arguments = parsToArg(input);
+                controller.link(id).then(this, [this, options](bool linked) {
+                    if (!linked) {
+                        qDebug() << "link error";
+                        runningLevelDone();
+                    } else {
+                        controller.run(options);
+                    }
+                });
             } else if (type == 4) {
-                if (!controller.link(id)) {
-                    qDebug() << "link error";
-                    runningLevelDone();
-                } else {
-                    options.id = id;
-                    options.command = STEAM;
-                    controller.run(options);
-                }
+                options.id = id;
+                options.command = STEAM;
+                controller.link(id).then(this, [this, options](bool linked) {
+                    if (!linked) {
+                        qDebug() << "link error";
+                        runningLevelDone();
+                    } else {
+                        controller.run(options);
+                    }
+                });
             } else if (type == 5) {
-                if (!controller.link(id)) {
-                    qDebug() << "link error";
-                }
-                QApplication::quit();
+                controller.link(id).then(this, [](bool linked) {
+                    if (!linked) {
+                        qDebug() << "link error";
+                    }
+                    QApplication::quit();
+                });
             } else if (type == 6) {
-                if (!controller.link(id)) {
-                    qDebug() << "link error";
-                }
-                runningLevelDone();
+                controller.link(id).then(this, [this](bool linked) {
+                    if (!linked) {
+                        qDebug() << "link error";
+                    }
+                    runningLevelDone();
+                });
             } else if (type == 7) {
                 options.id = id;
                 options.command = BASH;
@@ -708,6 +902,16 @@ void UiLevels::runningLevelDone() {
     controller.clearRunner();
 }
 
+void UiLevels::spaceFreed(quint64 bytes) {
+    // Levels removed close together add up in one notice
+    m_spaceFreed += bytes;
+    const QString text = QString("Freed %1 MiB").arg(
+        static_cast<double>(m_spaceFreed) / (1024 * 1024), 0, 'f', 1);
+    select->stackedWidgetBar->navigateWidgetBar->labelStatus->setText(text);
+    m_spaceFreedTimer->start();
+    qInfo() << "Removed level files:" << text;
+}
+
 QStringList UiLevels::parsToArg(const QString& str) {
     static const QRegularExpression re = QRegularExpression("\\s+");
     QStringList list = str.split(re, Qt::SkipEmptyParts);
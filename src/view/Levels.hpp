@@ -15,9 +15,11 @@
 #include <QComboBox>
 #include <QGroupBox>
 #include <QLabel>
+#include <QMap>
 #include <QProgressBar>
 #include <QPushButton>
 #include <QRadioButton>
+#include <QTimer>
 #include <QWebEngineView>
 #include <QListWidget>
 #include <QtSvg/QSvgRenderer>
@@ -102,15 +104,30 @@ public slots:
     void loadMoreCovers();
 
     /**
-     * Updates progress by 1% of total work steps.
+     * Adds a page of level cards read by the streaming list loader.
      */
-    void workTick();
+    void listPage(QVector<QSharedPointer<ListItemData>> page, bool last);
+
+    /**
+     * Adds the next decoded screenshot to the Info page gallery.
+     */
+    void infoImage(qint64 id, QImage image);
+
+    /**
+     * Shows the install progress, sampled by the progress timer.
+     */
+    void progressSample();
 
     /**
      * Switch back to list selection state after running the game.
      */
     void runningLevelDone();
 
+    /**
+     * Shows the disk space given back after a removed level is reaped.
+     */
+    void spaceFreed(quint64 bytes);
+
     /**
      * Displays an error dialog for a curl download error.
      */
@@ -126,6 +143,11 @@ public slots:
      */
     void runClicked();
 
+    /**
+     * Runs the full-text search for the search box text and type.
+     */
+    void searchChanged();
+
 signals:
     void downloadOrRemoveClickedSignal();
 
@@ -138,6 +160,15 @@ private:
     bool m_wasDownloading;
     qint64 m_wasDownloadingTimes;
     bool m_listSet;
+    bool m_listFirstPage;
+    bool m_coversLoading;
+    qint64 m_infoId;
+    const QSize m_screenSize = QSize(502, 377);  ///< Info gallery icon size
+    QString m_searchText;
+    QTimer *m_progressTimer{nullptr};  ///< Samples Progress at display rate
+    QTimer *m_spaceFreedTimer{nullptr};  ///< Clears the space freed notice
+    quint64 m_spaceFreed = 0;  ///< Bytes freed since the notice was shown
+    QMap<QString, qint64> m_restoreOptions;  ///< Dialog text to snapshot id
 
     struct InstalledStatus {
         QHash<quint64, bool> game;
@@ -147,7 +178,11 @@ private:
     QStringList parsToArg(const QString& str);
     QVector<QPair<QString, QString>> parsToEnv(const QString& str);
     InstalledStatus getInstalled();
+    InstalledStatus m_installedStatus;
     void setList();
+    void showInfo(qint64 id, const LevelDetail& detail);
+    void showRemoveDialog(bool haveZip);
+    void showRestoreDialog(const QVector<qint64>& snapshots);
     void levelDirSelected(qint64 id);
     void callbackDialog(QString selected);
     void setStackedWidget(const QString &qwidget);
@@ -93,7 +93,9 @@ void Dialog::setOptions(const QStringList &options) {
     }
 
     if (options.isEmpty()) {
+        // OK only closes the dialog, not the last single option
         m_optionContainer->hide();
+        m_oneOptionHolder.clear();
     } else if (options.size() == 1) {
         m_optionContainer->hide();
         m_oneOptionHolder = options.at(0);
@@ -32,6 +32,8 @@ Select::Select(QWidget *parent)
     levelListProxy = new LevelListProxy(this);
     levelListProxy->setSourceModel(levelListModel);
     levelViewList->setModel(levelListProxy);
+    connect(levelListModel, &QAbstractItemModel::rowsInserted,
+            this, &Select::levelsInserted);
 
     CardItemDelegate* delegate = new CardItemDelegate(levelViewList);
     levelViewList->setItemDelegate(delegate);
@@ -134,15 +136,6 @@ Select::Select(QWidget *parent)
 
     FilterGroupBoxSearch* filterGroupBoxSearch =
         filter->filterFirstInputRow->filterGroupBoxSearch;
-    connect(filterGroupBoxSearch->comboBoxSearch,
-            &QComboBox::currentTextChanged,
-            levelListProxy,
-            &LevelListProxy::setSearchType);
-
-    connect(filterGroupBoxSearch->lineEditSearch,
-            &QLineEdit::textChanged,
-            levelListProxy,
-            &LevelListProxy::setSearchFilter);
 
     connect(levelViewList,
             &LevelViewList::levelViewListKeyReturn
@@ -160,11 +153,23 @@ Select::Select(QWidget *parent)
 
 }
 
+void Select::setSearchResult(bool active, const QSet<quint64> &lids) {
+    levelListProxy->setSearchResult(active, lids);
+}
+
 void Select::setLevels(
     QVector<QSharedPointer<ListItemData>> &list) {
     levelListModel->setLevels(list);
 }
 
+void Select::appendLevels(
+    QVector<QSharedPointer<ListItemData>> &list, bool flush) {
+    levelListModel->appendLevels(list);
+    if (flush == true) {
+        levelListModel->fetchMore(QModelIndex());
+    }
+}
+
 bool Select::stop() {
     return levelListModel->stop();
 }
@@ -177,6 +182,10 @@ void  Select::reset() {
     levelListModel->reset();
 }
 
+void Select::takeCovers() {
+    levelListModel->takeCovers();
+}
+
 void Select::setItemChanged(const QModelIndex &current) {
     if (current.isValid()) {
         m_current = levelListProxy->mapToSource(current);
@@ -209,6 +218,27 @@ quint64 Select::getLid() {
     return levelListProxy->getLid(m_current);
 }
 
+QList<qint64> Select::getNeighbourLids(
+        const QModelIndex &current, int radius) {
+    // Selected first, then outwards in the order the cards are shown
+    QList<qint64> result;
+    if (current.isValid()) {
+        for (int d = 0; d <= radius; d++) {
+            for (int row : {current.row() + d, current.row() - d}) {
+                QModelIndex index = levelListProxy->index(row, 0);
+                if (index.isValid()) {
+                    qint64 lid = levelListProxy->getLid(
+                            levelListProxy->mapToSource(index));
+                    if (!result.contains(lid)) {
+                        result << lid;
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
+
 bool Select::getType() {
     return levelListProxy->getItemType(m_current);
 }
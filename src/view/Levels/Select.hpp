@@ -24,17 +24,24 @@ public:
 
     void setItemChanged(const QModelIndex &current);
     void setSortMode(LevelListProxy::SortMode mode);
+    void setSearchResult(bool active, const QSet<quint64> &lids);
     void setRemovedLevel();
     void setInstalledLevel();
     bool getType();
     quint64 getLid();
+    QList<qint64> getNeighbourLids(const QModelIndex &current, int radius);
     void setLevels(QVector<QSharedPointer<ListItemData>> &list);
+    void appendLevels(QVector<QSharedPointer<ListItemData>> &list, bool flush);
     bool stop();
     void  reset();
+    void takeCovers();
     QVector<QSharedPointer<ListItemData>> getDataBuffer(quint64 lenght);
     void downloadingState(bool state);
     void setCurrentWidgetBar(const StackedWidgetBar::index i);
 
+signals:
+    void levelsInserted();
+
 private:
     QModelIndex m_current;
     LevelListModel *levelListModel;
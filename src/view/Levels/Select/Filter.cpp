@@ -74,7 +74,7 @@ FilterGroupBoxSearch::FilterGroupBoxSearch(QWidget *parent)
     layout->setSpacing(6);
 
     comboBoxSearch->addItems(QStringList()
-        << "Level" << "Author"
+        << "Level" << "Author" << "Description"
         );
     layout->addWidget(comboBoxSearch);
     layout->addWidget(lineEditSearch);
@@ -70,6 +70,14 @@ void LevelViewList::paintEvent(QPaintEvent *event)
     }
 }
 
+void LevelViewList::rowsInserted(
+        const QModelIndex &parent, int start, int end)
+{
+    QListView::rowsInserted(parent, start, end);
+    // New rows from the streaming list loader have no covers yet
+    m_coversLoaded = false;
+}
+
 void LevelViewList::resizeEvent(QResizeEvent *event)
 {
     QListView::resizeEvent(event);
@@ -111,32 +119,96 @@ void LevelViewList::updateVisibleItems()
 void LevelListModel::setLevels(
         const QVector<QSharedPointer<ListItemData>>& levels) {
     beginResetModel();
-    m_levels = levels;
+    m_catalog.clear();
+    m_catalog.append(levels);
+    m_revision++;
+    m_pending.clear();
+    m_coverRequest.clear();
+    m_viewItems.clear();
+    m_cursor_a = 0;
+    m_cursor_b = 0;
     endResetModel();
 }
 
+void LevelListModel::appendLevels(
+        const QVector<QSharedPointer<ListItemData>>& levels) {
+    m_pending << levels;
+}
+
+bool LevelListModel::canFetchMore(const QModelIndex &parent) const {
+    return !parent.isValid() && !m_pending.isEmpty();
+}
+
+void LevelListModel::fetchMore(const QModelIndex &parent) {
+    if (canFetchMore(parent)) {
+        const int first = m_catalog.size();
+        beginInsertRows(QModelIndex(), first, first + m_pending.size() - 1);
+        m_catalog.append(m_pending);
+        m_pending.clear();
+        m_revision++;
+        endInsertRows();
+    }
+}
+
 int LevelListModel::rowCount(const QModelIndex &parent) const {
-    return parent.isValid() ? 0 : m_levels.size();
+    return parent.isValid() ? 0 : m_catalog.size();
 }
 
 void LevelListModel::setInstalled(const QModelIndex &index) {
-    ListItemData &item = *m_levels[index.row()];
-    item.m_installed = true;
+    m_catalog.setInstalled(index.row(), true);
+    m_revision++;
 }
 
 void LevelListModel::clearInstalled(const QModelIndex &index) {
-    ListItemData &item = *m_levels[index.row()];
-    item.m_installed = false;
+    m_catalog.setInstalled(index.row(), false);
+    m_revision++;
 }
 
 QVariant LevelListModel::data(const QModelIndex &index, int role) const {
     QVariant result;
 
-    if (index.isValid() && index.row() < m_levels.size()) {
-        const ListItemData &item = *m_levels[index.row()];
-        const auto it = m_roleTable.find(role);
-        if (it != m_roleTable.end()) {
-            result = it.value()(item);
+    if (index.isValid() && index.row() < m_catalog.size()) {
+        const qint64 row = index.row();
+        switch (role) {
+        case Qt::DisplayRole:
+            result = m_catalog.title(row);
+            break;
+        case Qt::UserRole+1:
+            // Original games are not in the catalog
+            result = qint64(0);
+            break;
+        case Qt::UserRole+2:
+            result = m_catalog.type(row);
+            break;
+        case Qt::UserRole+3:
+            result = m_catalog.release(row);
+            break;
+        case Qt::UserRole+4:
+            result = m_catalog.cover(row);
+            break;
+        case Qt::UserRole+5:
+            result = QString();
+            break;
+        case Qt::UserRole+6:
+            result = m_catalog.authors(row);
+            break;
+        case Qt::UserRole+7:
+            result = m_catalog.levelClass(row);
+            break;
+        case Qt::UserRole+8:
+            result = m_catalog.difficulty(row);
+            break;
+        case Qt::UserRole+9:
+            result = m_catalog.duration(row);
+            break;
+        case Qt::UserRole+10:
+            result = m_catalog.trleId(row);
+            break;
+        case Qt::UserRole+11:
+            result = m_catalog.installed(row);
+            break;
+        default:
+            break;
         }
     }
 
@@ -144,34 +216,54 @@ QVariant LevelListModel::data(const QModelIndex &index, int role) const {
 }
 
 inline quint64 LevelListModel::indexInBounds(const quint64 index) const {
-    return qMin(index, quint64(m_levels.size()));
+    return qMin(index, quint64(m_catalog.size()));
 }
 
 void LevelListModel::setScrollChanged(QModelIndexList list) {
-    if (!m_levels.empty()) {
+    if (m_catalog.size() != 0) {
         m_viewItems << list;
     }
 }
 
+QSharedPointer<ListItemData> LevelListModel::requestCover(qint64 row) {
+    QSharedPointer<ListItemData> item;
+    if (!m_catalog.hasCover(row)) {
+        item = QSharedPointer<ListItemData>::create();
+        item->setLid(m_catalog.trleId(row));
+        m_coverRequest.append(qMakePair(row, item));
+    }
+    return item;
+}
+
 QVector<QSharedPointer<ListItemData>>
         LevelListModel::getChunk(QModelIndexList list) {
     QVector<QSharedPointer<ListItemData>> result;
     for (QModelIndex& item : list) {
-        result << m_levels.at(item.row());
+        QSharedPointer<ListItemData> request = requestCover(item.row());
+        if (!request.isNull()) {
+            result << request;
+        }
     }
     return result;
 }
 
 QVector<QSharedPointer<ListItemData>>
         LevelListModel::getChunk(const quint64 cursor, const quint64 items) {
-    const quint64 len = indexInBounds(cursor + items) - cursor;
-    return m_levels.mid(cursor, len);
+    QVector<QSharedPointer<ListItemData>> result;
+    const quint64 end = indexInBounds(cursor + items);
+    for (quint64 row = cursor; row < end; row++) {
+        QSharedPointer<ListItemData> request = requestCover(row);
+        if (!request.isNull()) {
+            result << request;
+        }
+    }
+    return result;
 }
 
 QVector<QSharedPointer<ListItemData>>
         LevelListModel::getDataBuffer(quint64 items) {
     QVector<QSharedPointer<ListItemData>> chunk;
-    if (!m_levels.isEmpty()) {
+    if (m_catalog.size() != 0) {
         if (!m_viewItems.isEmpty()) {
             chunk = getChunk(m_viewItems);
         } else {
@@ -183,6 +275,18 @@ QVector<QSharedPointer<ListItemData>>
     return chunk;
 }
 
+void LevelListModel::takeCovers() {
+    // Called when the cover thread is done with all requested items
+    for (const auto& request : m_coverRequest) {
+        if (!request.second->m_cover.isNull()) {
+            m_catalog.setCover(request.first, request.second->m_cover);
+            QModelIndex item(index(request.first, 0));
+            emit dataChanged(item, item);
+        }
+    }
+    m_coverRequest.clear();
+}
+
 void LevelListModel::updateCovers(QModelIndexList list) {
     for (QModelIndex& item : list) {
         emit dataChanged(item, item);
@@ -207,8 +311,21 @@ void LevelListModel::reset() {
     }
 }
 
+const QVector<quint32>& LevelListModel::sortRank(LevelCatalog::SortKey key) {
+    return m_catalog.sortRank(key);
+}
+
+QVector<quint64> LevelListModel::filterBits(
+        const LevelCatalog::Filter& filter) {
+    return m_catalog.filter(filter);
+}
+
+QVector<quint64> LevelListModel::rowsOf(const QSet<quint64>& lids) const {
+    return m_catalog.rowsOf(lids);
+}
+
 bool LevelListModel::stop() const {
-    return m_viewItems.isEmpty() && (m_cursor_b >= m_levels.size());
+    return m_viewItems.isEmpty() && (m_cursor_b >= m_catalog.size());
 }
 
 void LevelListProxy::update() {
@@ -237,6 +354,7 @@ void LevelListProxy::setClassFilter(const QString &c) {
 #else
     beginFilterChange();
 #endif
+    m_acceptRevision = -1;
     if (c == m_all) {
         m_class = 0;
     } else {
@@ -254,6 +372,7 @@ void LevelListProxy::setTypeFilter(const QString &t) {
 #else
     beginFilterChange();
 #endif
+    m_acceptRevision = -1;
     if (t == m_all) {
         m_type = 0;
     } else {
@@ -271,6 +390,7 @@ void LevelListProxy::setDifficultyFilter(const QString &d) {
 #else
     beginFilterChange();
 #endif
+    m_acceptRevision = -1;
     if (d == m_all) {
         m_difficulty = 0;
     } else {
@@ -288,6 +408,7 @@ void LevelListProxy::setDurationFilter(const QString &d) {
 #else
     beginFilterChange();
 #endif
+    m_acceptRevision = -1;
     if(d == m_all) {
         m_duration = 0;
     } else {
@@ -300,29 +421,15 @@ void LevelListProxy::setDurationFilter(const QString &d) {
 #endif
 }
 
-void LevelListProxy::setSearchFilter(const QString &s) {
+void LevelListProxy::setSearchResult(
+        bool active, const QSet<quint64> &lids) {
 #if QT_VERSION < QT_VERSION_CHECK(6, 10, 0)
 #else
     beginFilterChange();
 #endif
-    m_search = s;
-#if QT_VERSION < QT_VERSION_CHECK(6, 10, 0)
-    invalidateFilter();
-#else
-    endFilterChange();
-#endif
-}
-
-void LevelListProxy::setSearchType(const QString &t) {
-#if QT_VERSION < QT_VERSION_CHECK(6, 10, 0)
-#else
-    beginFilterChange();
-#endif
-    if (t == "Level") {
-        m_searchType = 0;
-    } else if (t ==  "Author") {
-        m_searchType = 1;
-    }
+    m_acceptRevision = -1;
+    m_searchActive = active;
+    m_searchResult = lids;
 #if QT_VERSION < QT_VERSION_CHECK(6, 10, 0)
     invalidateFilter();
 #else
@@ -335,6 +442,7 @@ void LevelListProxy::setInstalledFilter(bool on) {
 #else
     beginFilterChange();
 #endif
+    m_acceptRevision = -1;
     m_installed = on;
 #if QT_VERSION < QT_VERSION_CHECK(6, 10, 0)
     invalidateFilter();
@@ -345,109 +453,60 @@ void LevelListProxy::setInstalledFilter(bool on) {
 
 void LevelListProxy::setSortMode(SortMode mode) {
     if (m_sortMode == mode) {
-        // same mode, toggle order
+        // same mode, toggle order, re-sorted on the same cached ranks
         m_sortOrder = (m_sortOrder == Qt::AscendingOrder) ?
                         Qt::DescendingOrder : Qt::AscendingOrder;
     } else {
-        // new mode, reset order
+        // new mode, reset order and re-sort on the new ranks
         m_sortMode = mode;
         m_sortOrder = Qt::DescendingOrder;
+        m_rankRevision = -1;
+        invalidate();
     }
-    invalidate();
     this->sort(0, m_sortOrder);
 }
 
+void LevelListProxy::setSourceModel(QAbstractItemModel *model) {
+    m_model = qobject_cast<LevelListModel*>(model);
+    Q_ASSERT_WITH_TRACE(m_model != nullptr);
+    m_rankRevision = -1;
+    QSortFilterProxyModel::setSourceModel(model);
+}
+
 bool LevelListProxy::lessThan(const QModelIndex &left,
                               const QModelIndex &right) const {
-    const quint64 role = roleForMode();
-    QVariant l = sourceModel()->data(left, role);
-    QVariant r = sourceModel()->data(right, role);
-
-    bool less = false;
-    switch (m_sortMode) {
-    case Title:
-        less = l.toString().localeAwareCompare(r.toString().toUpper()) < 0;
-        break;
-    case ReleaseDate:
-        less = l.toDateTime() < r.toDateTime();
-        break;
-    case Difficulty:
-    case Duration:
-    case Class:
-    case Type:
-        less = l.toUInt() < r.toUInt();
-        break;
-    default:
-        less = false;
-        break;
+    // Ranks are computed once per sort mode, looked up once per sort,
+    // so a compare is a plain int compare
+    if (m_rankRevision != m_model->revision()) {
+        m_rank = &m_model->sortRank(m_sortKeyTable[m_sortMode]);
+        m_rankRevision = m_model->revision();
     }
-    return less;
+    return (*m_rank)[left.row()] < (*m_rank)[right.row()];
 }
 
 bool LevelListProxy::filterAcceptsRow(int sourceRow,
         const QModelIndex &parent) const {
-    QModelIndex idx = sourceModel()->index(sourceRow, 0, parent);
-    bool status = true;
-
-    auto gameClass = sourceModel()->data(idx, Qt::UserRole+7).toUInt();
-    if ((m_class != 0)  && (m_class != gameClass)) {
-        status = false;
-    }
-
-    if (status == true) {
-        auto type = sourceModel()->data(idx, Qt::UserRole+2).toUInt();
-        if ((m_type != 0) && (m_type != type)) {
-            status = false;
-        }
-    }
-
-    if (status == true) {
-        auto difficulty = sourceModel()->data(idx, Qt::UserRole+8).toUInt();
-        if ((m_difficulty != 0) && (m_difficulty != difficulty)) {
-            status = false;
-        }
-    }
-
-    if (status == true) {
-        auto duration = sourceModel()->data(idx, Qt::UserRole+9).toUInt();
-        if ((m_duration != 0) && (m_duration != duration)) {
-            status = false;
-        }
-    }
-
-    if (status == true) {
-        auto installed = sourceModel()->data(idx, Qt::UserRole+11).toBool();
-        if (m_installed && !installed) {
-            status = false;
-        }
-    }
-
-    if (status == true) {
-        if (m_searchType == 0) {
-            auto title = sourceModel()->data(idx, Qt::DisplayRole).toString();
-            if (!m_search.isEmpty() &&
-                    !title.contains(m_search, Qt::CaseInsensitive)) {
-                status = false;
-            }
-        } else if (m_searchType == 1) {
-            auto authors = sourceModel()->data(idx, Qt::UserRole+6).toString();
-            if (!m_search.isEmpty() &&
-                    !authors.contains(m_search, Qt::CaseInsensitive)) {
-                status = false;
+    Q_UNUSED(parent);
+    // The accept bitset is rebuilt once per filter change or new rows
+    LevelListModel* model = qobject_cast<LevelListModel*>(sourceModel());
+    Q_ASSERT_WITH_TRACE(model != nullptr);
+    if (m_acceptRevision != model->revision()) {
+        LevelCatalog::Filter filter;
+        filter.levelClass = m_class;
+        filter.type = m_type;
+        filter.difficulty = m_difficulty;
+        filter.duration = m_duration;
+        filter.installed = m_installed;
+        m_accept = model->filterBits(filter);
+        if (m_searchActive == true) {
+            const QVector<quint64> search = model->rowsOf(m_searchResult);
+            for (qint64 i = 0; i < m_accept.size(); i++) {
+                m_accept[i] &= search[i];
             }
         }
+        m_acceptRevision = model->revision();
     }
-
-    return status;
-}
-
-int LevelListProxy::roleForMode() const {
-    int index = static_cast<int>(m_sortMode);
-    int result = Qt::UserRole+3; // default ReleaseDate
-    if (index >= 0 && index < static_cast<int>(std::size(m_roleForModeTable))) {
-        result = m_roleForModeTable[index];
-    }
-    return result;
+    return LevelCatalog::testRow(m_accept, sourceRow);
 }
 
 void CardItemDelegate::paint(QPainter *painter,
@@ -18,9 +18,11 @@
 #include <QStyledItemDelegate>
 #include <QSortFilterProxyModel>
 #include <QAbstractItemModel>
+#include <QSet>
 #include <qobject.h>
 
 #include "../src/Data.hpp"
+#include "../src/LevelCatalog.hpp"
 
 class LevelViewList : public QListView {
     Q_OBJECT
@@ -37,6 +39,7 @@ protected:
     void paintEvent(QPaintEvent *event) override;
     void resizeEvent(QResizeEvent* event) override;
     void keyPressEvent(QKeyEvent *event) override;
+    void rowsInserted(const QModelIndex &parent, int start, int end) override;
 
 private:
     void updateVisibleItems();
@@ -54,35 +57,30 @@ class LevelListModel : public QAbstractListModel {
     explicit LevelListModel(QObject *parent = nullptr)
         : QAbstractListModel(parent),
         m_cursor_a(0),
-        m_cursor_b(0),
-        m_roleTable({
-            { Qt::DisplayRole,  [](const ListItemData &i){ return i.m_title; }},
-            { Qt::UserRole+1,   [](const ListItemData &i){ return i.m_game_id; }},
-            { Qt::UserRole+2,   [](const ListItemData &i){ return i.m_type; }},
-            { Qt::UserRole+3,   [](const ListItemData &i){ return i.m_releaseDate; }},
-            { Qt::UserRole+4,   [](const ListItemData &i){ return i.m_cover; }},
-            { Qt::UserRole+5,   [](const ListItemData &i){ return i.m_shortBody; }},
-            { Qt::UserRole+6,   [](const ListItemData &i){ return i.m_authors; }},
-            { Qt::UserRole+7,   [](const ListItemData &i){ return i.m_class; }},
-            { Qt::UserRole+8,   [](const ListItemData &i){ return i.m_difficulty; }},
-            { Qt::UserRole+9,   [](const ListItemData &i){ return i.m_duration; }},
-            { Qt::UserRole+10,  [](const ListItemData &i){ return i.m_trle_id; }},
-            { Qt::UserRole+11,  [](const ListItemData &i){ return i.m_installed; }},
-        })
+        m_cursor_b(0)
     {}
 
     QVector<QSharedPointer<ListItemData>> getChunk(QModelIndexList list);
     QVector<QSharedPointer<ListItemData>> getChunk(const quint64 cursor,
                                                     const quint64 items);
     QVector<QSharedPointer<ListItemData>> getDataBuffer(const quint64 items);
+    void takeCovers();
 
     void setLevels(const QVector<QSharedPointer<ListItemData>>& levels);
+    void appendLevels(const QVector<QSharedPointer<ListItemData>>& levels);
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
     void setScrollChanged(QModelIndexList list);
     void setInstalled(const QModelIndex &index);
 
     void clearInstalled(const QModelIndex &index);
     quint64 indexInBounds(quint64 index) const;
     bool stop() const;
+    const QVector<quint32>& sortRank(LevelCatalog::SortKey key);
+    QVector<quint64> filterBits(const LevelCatalog::Filter& filter);
+    QVector<quint64> rowsOf(const QSet<quint64>& lids) const;
+    /// Bumped whenever rows or the installed state change
+    qint64 revision() const { return m_revision; }
     void updateCovers(quint64 a, quint64 b);
     void updateCovers(QModelIndexList list);
     void reset();
@@ -90,14 +88,18 @@ class LevelListModel : public QAbstractListModel {
     QVariant data(const QModelIndex &index, int role) const override;
 
  private:
-    const QHash<int, std::function<QVariant(const ListItemData&)>> m_roleTable;
-    QVector<QSharedPointer<ListItemData>> m_levels;
+    QSharedPointer<ListItemData> requestCover(qint64 row);
+
+    LevelCatalog m_catalog;
+    QVector<QSharedPointer<ListItemData>> m_pending;  ///< Read, not inserted
+    /// Rows waiting for the cover thread, and the item it fills
+    QVector<QPair<qint64, QSharedPointer<ListItemData>>> m_coverRequest;
     QModelIndexList m_viewItems;
     quint64 m_cursor_a;
     quint64 m_cursor_b;
+    qint64 m_revision = 0;
 };
 
-
 class LevelListProxy : public QSortFilterProxyModel {
     Q_OBJECT
 
@@ -108,7 +110,7 @@ class LevelListProxy : public QSortFilterProxyModel {
         m_type(0),
         m_difficulty(0),
         m_duration(0),
-        m_searchType(0),
+        m_searchActive(false),
         m_all(" - All -"),
         m_installed(false),
         m_sortMode(ReleaseDate)
@@ -123,8 +125,7 @@ class LevelListProxy : public QSortFilterProxyModel {
     void setTypeFilter(const QString &t);
     void setDifficultyFilter(const QString &d);
     void setDurationFilter(const QString &d);
-    void setSearchFilter(const QString &s);
-    void setSearchType(const QString &t);
+    void setSearchResult(bool active, const QSet<quint64> &lids);
     void setInstalledFilter(bool on);
 
     enum SortMode {
@@ -137,6 +138,7 @@ class LevelListProxy : public QSortFilterProxyModel {
     };
 
     void setSortMode(SortMode mode);
+    void setSourceModel(QAbstractItemModel *model) override;
 
  protected:
     bool lessThan(const QModelIndex &left,
@@ -145,22 +147,30 @@ class LevelListProxy : public QSortFilterProxyModel {
             const QModelIndex &parent) const override;
 
  private:
-    int roleForMode() const;
-    static constexpr int m_roleForModeTable[6] = {
-        Qt::DisplayRole,
-        Qt::UserRole+8,
-        Qt::UserRole+9,
-        Qt::UserRole+7,
-        Qt::UserRole+2,
-        Qt::UserRole+3
+    static constexpr LevelCatalog::SortKey m_sortKeyTable[6] = {
+        LevelCatalog::SortKey::Title,
+        LevelCatalog::SortKey::Difficulty,
+        LevelCatalog::SortKey::Duration,
+        LevelCatalog::SortKey::Class,
+        LevelCatalog::SortKey::Type,
+        LevelCatalog::SortKey::Release
     };
     SortMode m_sortMode = ReleaseDate;
     Qt::SortOrder m_sortOrder = Qt::DescendingOrder;
     quint64 m_class, m_type, m_difficulty, m_duration;
     const QString m_all;
-    QString m_search;
-    quint64 m_searchType;
+    bool m_searchActive;
+    QSet<quint64> m_searchResult;  ///< trle.net lids matched by the search
     bool m_installed;
+    /// Rows that pass all filters, rebuilt when the model revision or a
+    /// filter changes
+    mutable QVector<quint64> m_accept;
+    mutable qint64 m_acceptRevision = -1;
+    LevelListModel* m_model = nullptr;
+    /// Ranks of the sort mode, looked up again when the model revision or
+    /// the sort mode changes
+    mutable const QVector<quint32>* m_rank = nullptr;
+    mutable qint64 m_rankRevision = -1;
 };
 
 
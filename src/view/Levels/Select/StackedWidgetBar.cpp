@@ -20,6 +20,7 @@ NavigateWidgetBar::NavigateWidgetBar(QWidget *parent)
     pushButtonFilter(new QPushButton(("Filter/Sort"), this)),
     pushButtonInfo(new QPushButton(("Info"), this)),
     pushButtonDownload(new QPushButton(("Download and install"), this)),
+    labelStatus(new QLabel(this)),
     layout(new QHBoxLayout(this))
 
 {
@@ -45,6 +46,9 @@ NavigateWidgetBar::NavigateWidgetBar(QWidget *parent)
     pushButtonDownload->setEnabled(false);
     pushButtonDownload->setFixedSize(242, 32);
     layout->addWidget(pushButtonDownload);
+
+    // Short notices, like the space freed by a removed level
+    layout->addWidget(labelStatus, 1);
 }
 
 ProgressWidgetBar::ProgressWidgetBar(QWidget *parent)
@@ -56,6 +60,8 @@ ProgressWidgetBar::ProgressWidgetBar(QWidget *parent)
     layout->setContentsMargins(0, 0, 0, 0);
     layout->setSpacing(8);
 
+    // Permille of the install, see Progress
+    progressBar->setRange(0, 1000);
     layout->addWidget(progressBar);
 }
 
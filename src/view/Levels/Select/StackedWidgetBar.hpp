@@ -6,6 +6,7 @@
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QCheckBox>
+#include <QLabel>
 #include <QPushButton>
 #include <QProgressBar>
 #include <QStackedWidget>
@@ -23,7 +24,8 @@ public:
      * ├── pushButtonFilter
      * ├── pushButtonDownload
      * ├── pushButtonInfo
-     * └── pushButtonRun
+     * ├── pushButtonRun
+     * └── labelStatus
      */
     explicit NavigateWidgetBar(QWidget *parent);
     QCheckBox *checkBoxSetup{nullptr};
@@ -31,6 +33,7 @@ public:
     QPushButton *pushButtonDownload{nullptr};
     QPushButton *pushButtonInfo{nullptr};
     QPushButton *pushButtonRun{nullptr};
+    QLabel *labelStatus{nullptr};
 private:
     UiState& g_uistate = UiState::getInstance();
     QHBoxLayout *layout{nullptr};
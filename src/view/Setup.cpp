@@ -47,6 +47,12 @@ void UiSetup::readSavedSettings() {
     widgetDeleteZip->checkBoxDeleteZip->setChecked(deleteZip);
     qDebug() << "Read level DeleteZip (after download) value:" << deleteZip;
 
+    WidgetDedupeLevels* widgetDedupeLevels =
+        this->settings->frameGlobalSetup->widgetDedupeLevels;
+    const bool dedupeLevels = g_settings.value("DedupeLevels", false).toBool();
+    widgetDedupeLevels->checkBoxDedupeLevels->setChecked(dedupeLevels);
+    qDebug() << "Read level DedupeLevels value:" << dedupeLevels;
+
     WidgetDefaultEnvironmentVariables* widgetDefaultEnvironmentVariables =
         this->settings->frameGlobalSetup->widgetDefaultEnvironmentVariables;
     const QString defaultEnvironmentVariables =
@@ -124,6 +130,11 @@ void UiSetup::globalSaveClicked() {
             widgetDeleteZip->checkBoxDeleteZip->isChecked();
     g_settings.setValue("DeleteZip" , newDeleteZip);
 
+    const bool newDedupeLevels =
+        this->settings->frameGlobalSetup->
+            widgetDedupeLevels->checkBoxDedupeLevels->isChecked();
+    g_settings.setValue("DedupeLevels" , newDedupeLevels);
+
     g_settings.setValue("defaultEnvironmentVariables",
         this->settings->frameGlobalSetup->widgetDefaultEnvironmentVariables->
             lineEditDefaultEnvironmentVariables->text());
@@ -148,6 +159,10 @@ void UiSetup::globalResetClicked() {
         widgetDeleteZip->checkBoxDeleteZip->setChecked(
             g_settings.value("DeleteZip").toBool());
 
+    this->settings->frameGlobalSetup->
+        widgetDedupeLevels->checkBoxDedupeLevels->setChecked(
+            g_settings.value("DedupeLevels", false).toBool());
+
     this->settings->frameGlobalSetup->widgetDefaultEnvironmentVariables->
         lineEditDefaultEnvironmentVariables->setText(
             g_settings.value("defaultEnvironmentVariables").toString());
@@ -404,6 +419,7 @@ FrameGlobalSetup::FrameGlobalSetup(QWidget *parent)
     widgetDefaultEnvironmentVariables(new WidgetDefaultEnvironmentVariables(this)),
     widgetDefaultRunnerType(new WidgetDefaultRunnerType(this)),
     widgetDeleteZip(new WidgetDeleteZip(this)),
+    widgetDedupeLevels(new WidgetDedupeLevels(this)),
     labelGlobalSetupPicture(new QLabel(this)),
     globalControl(new GlobalControl(this)),
     layout(new QVBoxLayout(this))
@@ -458,6 +474,7 @@ FrameGlobalSetup::FrameGlobalSetup(QWidget *parent)
     layout->addWidget(widgetDefaultEnvironmentVariables, Qt::AlignTop | Qt::AlignLeft);
     layout->addWidget(widgetDefaultRunnerType, Qt::AlignTop | Qt::AlignLeft);
     layout->addWidget(widgetDeleteZip, Qt::AlignTop | Qt::AlignLeft);
+    layout->addWidget(widgetDedupeLevels, Qt::AlignTop | Qt::AlignLeft);
     layout->addSpacerItem(
     new QSpacerItem(10, 10,
         QSizePolicy::Minimum,
@@ -522,6 +539,19 @@ WidgetDeleteZip::WidgetDeleteZip(QWidget *parent)
     layout->addWidget(checkBoxDeleteZip);
 }
 
+WidgetDedupeLevels::WidgetDedupeLevels(QWidget *parent)
+    : QWidget(parent),
+    checkBoxDedupeLevels(new QCheckBox(
+        tr("Share identical level files between installed levels"), this)),
+    layout(new QHBoxLayout(this))
+{
+    layout->setContentsMargins(6, 6, 6, 6);
+    layout->setSpacing(8);
+    setMaximumHeight(46);
+
+    layout->addWidget(checkBoxDedupeLevels);
+}
+
 FrameLevelSetup::FrameLevelSetup(QWidget *parent)
     : QFrame(parent),
     frameLevelSetupSettings(new FrameLevelSetupSettings(this)),
@@ -315,6 +315,21 @@ private:
     QHBoxLayout *layout{nullptr};
 };
 
+class WidgetDedupeLevels : public QWidget
+{
+    Q_OBJECT
+public:
+    /*
+     * (ui->tabs->setup->stackedWidget->settings->frameGlobalSetup)
+     * WidgetDedupeLevels
+     * └── checkBoxDedupeLevels
+     */
+    explicit WidgetDedupeLevels(QWidget *parent);
+    QCheckBox *checkBoxDedupeLevels{nullptr};
+private:
+    QHBoxLayout *layout{nullptr};
+};
+
 class FrameGlobalSetup : public QFrame
 {
     Q_OBJECT
@@ -327,6 +342,7 @@ public:
      * ├── widgetDefaultEnvironmentVariables ->
      * ├── widgetDefaultRunnerType ->
      * ├── widgetDeleteZip ->
+     * ├── widgetDedupeLevels ->
      * ├── labelGlobalSetupPicture
      * └── globalControl ->
      */
@@ -336,6 +352,7 @@ public:
     WidgetDefaultEnvironmentVariables *widgetDefaultEnvironmentVariables{nullptr};
     WidgetDefaultRunnerType *widgetDefaultRunnerType{nullptr};
     WidgetDeleteZip *widgetDeleteZip{nullptr};
+    WidgetDedupeLevels *widgetDedupeLevels{nullptr};
     QLabel *labelGlobalSetupPicture{nullptr};
     GlobalControl *globalControl{nullptr};
 private:
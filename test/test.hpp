@@ -14,14 +14,41 @@
 #ifndef TEST_TEST_HPP_
 #define TEST_TEST_HPP_
 
+#include <algorithm>
+#include <numeric>
 #include <random>
 #include <QtCore>
 #include <QtTest/QtTest>
+#include <sys/stat.h>
 // #include "../src/GameFileTree.hpp"
 // #include "../src/gameFileTreeData.hpp"
 #include "../src/Path.hpp"
 #include "../src/PyRunner.hpp"
 #include "../src/Model.hpp"
+#include "../src/CopyEngine.hpp"
+#include "../src/Data.hpp"
+#include "../src/FileHash.hpp"
+#include "../src/FileStore.hpp"
+#include "../src/HashCopy.hpp"
+#include "../src/LevelCatalog.hpp"
+#include "../src/Progress.hpp"
+#include "../src/QueryStats.hpp"
+#include "../src/SaveStore.hpp"
+#include "../src/TrashReaper.hpp"
+#include "../src/ZipExtractor.hpp"
+#include "../src/ZipStream.hpp"
+#include "../miniz/miniz.h"  // IWYU pragma: keep
+#include "../miniz/miniz_zip.h"
+
+/**
+ * @brief Write a test fixture file, making its directory first.
+ * @return `true` if all of data was written.
+ */
+inline bool writeTestFile(const QString& path, const QByteArray& data) {
+    QFile file(path);
+    return QDir().mkpath(QFileInfo(path).path()) &&
+        file.open(QIODevice::WriteOnly) && (file.write(data) == data.size());
+}
 
 class PyRunnerTest : public QObject {
     Q_OBJECT
@@ -89,4 +116,680 @@ class GameFileTreeTest : public QObject {
     Model& model = Model::getInstance();
     FileManager& fileManager = FileManager::getInstance();
 };
+class DataQueryPlanTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void initTestCase() {
+        Path::setTestProgramFilesPath();
+        Path::setTestResourcePath();
+        // Runs the schema migrations on the test copy of tombll.db
+        QVERIFY(data.initializeDatabase());
+    }
+
+    void hotQueriesUseIndexes_data() {
+        QTest::addColumn<int>("statement");
+        QTest::newRow("ListItems")
+            << static_cast<int>(Data::Statement::ListItems);
+        QTest::newRow("CoverMd5Batch")
+            << static_cast<int>(Data::Statement::CoverMd5Batch);
+        QTest::newRow("CoverDataBatch")
+            << static_cast<int>(Data::Statement::CoverDataBatch);
+        QTest::newRow("Info") << static_cast<int>(Data::Statement::Info);
+        QTest::newRow("Walkthrough")
+            << static_cast<int>(Data::Statement::Walkthrough);
+        QTest::newRow("Type") << static_cast<int>(Data::Statement::Type);
+        QTest::newRow("Download")
+            << static_cast<int>(Data::Statement::Download);
+        QTest::newRow("SetDownloadMd5")
+            << static_cast<int>(Data::Statement::SetDownloadMd5);
+        QTest::newRow("FileList")
+            << static_cast<int>(Data::Statement::FileList);
+        QTest::newRow("FileHashLookup")
+            << static_cast<int>(Data::Statement::FileHashLookup);
+    }
+
+    void hotQueriesUseIndexes() {
+        QFETCH(int, statement);
+        const QStringList plan =
+            data.getQueryPlan(static_cast<Data::Statement>(statement));
+        QVERIFY(!plan.isEmpty());
+        for (const QString& detail : plan) {
+            qDebug() << detail;
+            // Full scans show up as "SCAN <table>" or "SCAN TABLE <table>"
+            QVERIFY2(!detail.startsWith("SCAN"), qPrintable(detail));
+        }
+    }
+
+    void readerConnectionsAreReclaimed() {
+        const qint64 expected = data.getListRowCount();
+        const qsizetype before = QSqlDatabase::connectionNames().size();
+        QVector<qint64> rows(4, -1);
+        QList<QThread*> threads;
+        for (qint64 i = 0; i < rows.size(); i++) {
+            threads << QThread::create([this, &rows, i]() {
+                rows[i] = data.getListRowCount();
+            });
+            threads.last()->start();
+        }
+        for (QThread* thread : threads) {
+            QVERIFY(thread->wait());
+            delete thread;
+        }
+        for (const qint64 count : rows) {
+            QCOMPARE(count, expected);
+        }
+        // Each thread closes its connection as it ends
+        QTRY_COMPARE(QSqlDatabase::connectionNames().size(), before);
+    }
+
+    void idleThreadsDontHoldReaderSlots() {
+        // More threads than reader slots, each keeps its connection open
+        const qint64 expected = data.getListRowCount();
+        QVector<qint64> rows(12, -1);
+        QSemaphore done;
+        QSemaphore release;
+        QList<QThread*> threads;
+        for (qint64 i = 0; i < rows.size(); i++) {
+            threads << QThread::create([this, &rows, &done, &release, i]() {
+                rows[i] = data.getListRowCount();
+                done.release();
+                release.acquire();
+            });
+            threads.last()->start();
+        }
+        const bool allRead = done.tryAcquire(rows.size(), 10000);
+        release.release(rows.size());
+        for (QThread* thread : threads) {
+            QVERIFY(thread->wait());
+            delete thread;
+        }
+        QVERIFY(allRead);
+        for (const qint64 count : rows) {
+            QCOMPARE(count, expected);
+        }
+    }
+
+    void queryStatsRecordQueries() {
+        QueryStats& stats = QueryStats::getInstance();
+        stats.clear();
+        const qint64 rows = data.getListRowCount();
+        (void)data.getListPage(Data::m_listFirstRelease,
+                Data::m_listFirstId, 10);
+
+        const QJsonObject queries = stats.toJson()["queries"].toObject();
+        const QJsonObject count = queries["ListRowCount"].toObject();
+        QCOMPARE(count["count"].toInteger(), qint64(1));
+        QCOMPARE(count["rows"].toInteger(), qint64(1));
+        const QJsonObject page = queries["ListItems"].toObject();
+        QCOMPARE(page["rows"].toInteger(), qMin<qint64>(rows, 10));
+        QVERIFY(page["p50_us"].toInteger() <= page["p95_us"].toInteger());
+        QVERIFY(page["p95_us"].toInteger() <= page["max_us"].toInteger());
+    }
+
+ private:
+    Data& data = Data::getInstance();
+};
+
+class LevelCatalogTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void initTestCase() {
+        std::mt19937 gen(3718);
+        std::uniform_int_distribution<> author(1, m_authors);
+        std::uniform_int_distribution<> authorCount(1, 3);
+        std::uniform_int_distribution<> day(0, 9000);
+        std::uniform_int_distribution<> id(1, 12);
+        const QDate first(2000, 1, 1);
+
+        for (int i = 1; i <= m_levels; ++i) {
+            auto item = QSharedPointer<ListItemData>::create();
+            item->setLid(i);
+            item->setTitle(QString("The Lost Tomb of Level %1").arg(i));
+            // Split from the query result, one string per author and item
+            QStringList authors;
+            for (int a = authorCount(gen); a > 0; --a) {
+                authors << QString("Author %1").arg(author(gen));
+            }
+            item->setAuthors(authors);
+            item->setReleaseDate(
+                first.addDays(day(gen)).toString(Qt::ISODate));
+            item->setType(id(gen));
+            item->setClass(id(gen));
+            item->setDifficulty(id(gen) % 5);
+            item->setDuration(id(gen) % 5);
+            m_items.append(item);
+        }
+    }
+
+    void bytesPerLevel() {
+        const qint64 before = itemBytes();
+
+        LevelCatalog catalog;
+        QBENCHMARK_ONCE {
+            catalog.append(m_items);
+        }
+        QCOMPARE(catalog.size(), m_levels);
+        QCOMPARE(catalog.title(41), m_items.at(41)->m_title);
+        QCOMPARE(catalog.authors(41), m_items.at(41)->m_authors);
+        QCOMPARE(catalog.release(41).toString(Qt::ISODate),
+                 m_items.at(41)->m_releaseDate);
+        const qint64 after = catalog.bytes();
+
+        qInfo() << "ListItemData:" << before / m_levels << "bytes per level";
+        qInfo() << "LevelCatalog:" << after / m_levels << "bytes per level";
+        QVERIFY(after * 2 < before);
+    }
+
+    void filterBits() {
+        LevelCatalog catalog;
+        catalog.append(m_items);
+        LevelCatalog::Filter filter;
+        filter.type = 3;
+        filter.difficulty = 2;
+
+        QVector<quint64> bits;
+        QBENCHMARK {
+            bits = catalog.filter(filter);
+        }
+        for (qint64 row = 0; row < catalog.size(); ++row) {
+            const bool match = (catalog.type(row) == filter.type) &&
+                (catalog.difficulty(row) == filter.difficulty);
+            QCOMPARE(LevelCatalog::testRow(bits, row), match);
+        }
+    }
+
+    void sortRank() {
+        LevelCatalog catalog;
+        catalog.append(m_items);
+
+        const QVector<quint32>& release =
+            catalog.sortRank(LevelCatalog::SortKey::Release);
+        for (qint64 row = 1; row < catalog.size(); ++row) {
+            // Stable, equal release dates keep the catalog order
+            QCOMPARE(release[row - 1] < release[row],
+                catalog.releaseDay(row - 1) <= catalog.releaseDay(row));
+        }
+
+        (void)catalog.sortRank(LevelCatalog::SortKey::Title);
+        // Re-sort a permutation with the cached keys, as the proxy does
+        QVector<quint32> order(catalog.size());
+        std::iota(order.begin(), order.end(), 0);
+        QBENCHMARK {
+            const QVector<quint32>& rank =
+                catalog.sortRank(LevelCatalog::SortKey::Title);
+            std::sort(order.begin(), order.end(),
+                    [&rank](quint32 a, quint32 b) { return rank[a] < rank[b]; });
+        }
+    }
+
+ private:
+    static qint64 stringBytes(const QString& s) {
+        return sizeof(QArrayData) + s.capacity() * sizeof(QChar);
+    }
+
+    // Heap held by the old QVector<QSharedPointer<ListItemData>> list
+    qint64 itemBytes() const {
+        qint64 result = m_items.capacity() * sizeof(QSharedPointer<ListItemData>);
+        for (const QSharedPointer<ListItemData>& item : m_items) {
+            result += sizeof(QtSharedPointer::ExternalRefCountData);
+            result += sizeof(ListItemData);
+            result += stringBytes(item->m_title);
+            result += stringBytes(item->m_releaseDate);
+            result += sizeof(QArrayData) +
+                item->m_authors.capacity() * sizeof(QString);
+            for (const QString& author : item->m_authors) {
+                result += stringBytes(author);
+            }
+        }
+        return result;
+    }
+
+    static constexpr qint64 m_levels = 10000;
+    static constexpr int m_authors = 2000;
+    QVector<QSharedPointer<ListItemData>> m_items;
+};
+
+class ZipExtractorTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void initTestCase() {
+        QVERIFY(m_dir.isValid());
+        m_zipPath = m_dir.filePath("synthetic.zip");
+
+        // A few large tracks and many small level files, like a TRLE archive
+        std::mt19937 gen(4242);
+        std::uniform_int_distribution<> symbol(0, 15);
+        mz_zip_archive zip;
+        (void)memset(&zip, 0, sizeof(zip));
+        QVERIFY(mz_zip_writer_init_file(
+            &zip, m_zipPath.toUtf8().constData(), 0));
+        for (int i = 0; i < m_files; ++i) {
+            const qint64 size = (i % 25 == 0) ? 4 << 20 : 64 << 10;
+            QByteArray data(size, Qt::Uninitialized);
+            for (char& c : data) {
+                c = static_cast<char>('a' + symbol(gen));
+            }
+            const QByteArray name = (i % 25 == 0)
+                ? QString("audio/%1.wav").arg(i).toUtf8()
+                : QString("data/level%1.tr4").arg(i).toUtf8();
+            QVERIFY(mz_zip_writer_add_mem(&zip, name.constData(),
+                data.constData(), data.size(), MZ_DEFAULT_LEVEL));
+            m_totalBytes += size;
+        }
+        QVERIFY(mz_zip_writer_finalize_archive(&zip));
+        QVERIFY(mz_zip_writer_end(&zip));
+    }
+
+    void extractWorkers_data() {
+        QTest::addColumn<int>("workers");
+        QTest::newRow("1 worker") << 1;
+        QTest::newRow("2 workers") << 2;
+        QTest::newRow("4 workers") << 4;
+        QTest::newRow("8 workers") << 8;
+    }
+
+    void extractWorkers() {
+        QFETCH(int, workers);
+        const QString outputDir = m_dir.filePath(QString("out%1").arg(workers));
+        QVERIFY(QDir().mkpath(outputDir));
+
+        ZipExtractor extractor;
+        QCOMPARE(extractor.open(m_zipPath), 0);
+        QCOMPARE(extractor.entryCount(), m_files);
+        QCOMPARE(extractor.totalBytes(), m_totalBytes);
+
+        quint64 lastDone = 0;
+        int status = -1;
+        QBENCHMARK_ONCE {
+            status = extractor.extract(outputDir, workers,
+                    [&lastDone](quint64 done, quint64 total) {
+                QVERIFY(done >= lastDone);
+                QVERIFY(done <= total);
+                lastDone = done;
+            });
+        }
+        QCOMPARE(status, 0);
+        QCOMPARE(lastDone, m_totalBytes);
+        QCOMPARE(QFileInfo(outputDir + "/audio/0.wav").size(), qint64(4 << 20));
+        QCOMPARE(QFileInfo(outputDir + "/data/level1.tr4").size(),
+                 qint64(64 << 10));
+    }
+
+    void streamInChunks() {
+        QFile zipFile(m_zipPath);
+        QVERIFY(zipFile.open(QIODevice::ReadOnly));
+        const QString outputDir = m_dir.filePath("stream");
+
+        // Download sized chunks, so headers and entries straddle them
+        ZipStream stream(outputDir);
+        QBENCHMARK_ONCE {
+            while (!zipFile.atEnd()) {
+                const QByteArray chunk = zipFile.read(16 * 1024 + 7);
+                QVERIFY(stream.feed(chunk.constData(), chunk.size()));
+            }
+        }
+        QVERIFY(stream.isComplete());
+        QCOMPARE(stream.entryCount(), m_files);
+        QCOMPARE(stream.bytesWritten(), m_totalBytes);
+        QCOMPARE(QFileInfo(outputDir + "/audio/0.wav").size(), qint64(4 << 20));
+    }
+
+ private:
+    static constexpr qint64 m_files = 200;
+    QTemporaryDir m_dir;
+    QString m_zipPath;
+    quint64 m_totalBytes = 0;
+};
+
+class HashCopyTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void initTestCase() {
+        QVERIFY(m_dir.isValid());
+        std::mt19937 gen(1996);
+        for (int i = 0; i < 12; ++i) {
+            QByteArray data((i + 1) * 300000, Qt::Uninitialized);
+            for (char& c : data) {
+                c = static_cast<char>(gen());
+            }
+            const QString path = m_dir.filePath(QString("game/data/%1.tr2").arg(i));
+            QVERIFY(writeTestFile(path, data));
+            m_jobs.append({path, path, QString(
+                QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex())});
+            m_totalBytes += data.size();
+        }
+    }
+
+    void copyVerified() {
+        QVector<HashCopy::Job> jobs = destinations("copy");
+        HashCopy copier;
+        QCOMPARE(copier.run(jobs, 4), 0);
+        QCOMPARE(copier.doneBytes(), m_totalBytes);
+        for (const HashCopy::Job& job : jobs) {
+            QCOMPARE(QFileInfo(job.to).size(), QFileInfo(job.from).size());
+        }
+    }
+
+    void copyEngine() {
+        const HashCopy::Job& job = m_jobs.last();
+        const QString to = m_dir.filePath("engine.tr2");
+        const CopyEngine::Strategy strategy = CopyEngine::copy(job.from, to);
+        qInfo() << "CopyEngine:" << CopyEngine::strategyName(strategy);
+        QVERIFY(strategy != CopyEngine::Strategy::Failed);
+        QFile file(to);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(QString(QCryptographicHash::hash(
+            file.readAll(), QCryptographicHash::Md5).toHex()), job.md5sum);
+        // Never overwrites
+        QCOMPARE(CopyEngine::copy(job.from, to), CopyEngine::Strategy::Failed);
+    }
+
+    void mismatchRollsBack() {
+        QVector<HashCopy::Job> jobs = destinations("mismatch");
+        jobs[5].md5sum = "00000000000000000000000000000000";
+        HashCopy copier;
+        QCOMPARE(copier.run(jobs, 4), 2);
+        for (const HashCopy::Job& job : jobs) {
+            QVERIFY(!QFileInfo::exists(job.to));
+        }
+    }
+
+ private:
+    QVector<HashCopy::Job> destinations(const QString& name) const {
+        QVector<HashCopy::Job> jobs = m_jobs;
+        for (HashCopy::Job& job : jobs) {
+            job.to.replace(m_dir.filePath("game"), m_dir.filePath(name));
+        }
+        return jobs;
+    }
+
+    QTemporaryDir m_dir;
+    QVector<HashCopy::Job> m_jobs;
+    quint64 m_totalBytes = 0;
+};
+
+class FileStoreTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void initTestCase() {
+        QVERIFY(m_dir.isValid());
+        m_exe = QByteArray(256 * 1024, 'x');
+        for (const QString& level : {"1.TRLE", "2.TRLE", "3.TRLE"}) {
+            QVERIFY(writeTestFile(m_dir.filePath(level + "/tomb4.exe"),
+                m_exe));
+            QVERIFY(writeTestFile(m_dir.filePath(level + "/savegame.0"),
+                QByteArray(8192, 's')));
+        }
+    }
+
+    void linksIdenticalFiles() {
+        FileStore store(m_dir.filePath(".store"));
+        QCOMPARE(store.addTree(m_dir.filePath("1.TRLE")).savedBytes, quint64(0));
+        QCOMPARE(store.addTree(m_dir.filePath("2.TRLE")).savedBytes,
+                 quint64(m_exe.size()));
+        QCOMPARE(store.addTree(m_dir.filePath("3.TRLE")).files, qint64(1));
+
+        QCOMPARE(inode("1.TRLE/tomb4.exe"), inode("3.TRLE/tomb4.exe"));
+        QVERIFY(inode("1.TRLE/savegame.0") != inode("2.TRLE/savegame.0"));
+        const FileStore::Stats report = store.report();
+        QCOMPARE(report.files, qint64(1));
+        QCOMPARE(report.savedBytes, quint64(2 * m_exe.size()));
+    }
+
+    void breakLinkKeepsStore() {
+        const QString path = m_dir.filePath("2.TRLE/tomb4.exe");
+        QVERIFY(FileStore::breakLink(path));
+        QVERIFY(inode("1.TRLE/tomb4.exe") != inode("2.TRLE/tomb4.exe"));
+        QVERIFY(writeTestFile(path, QByteArray("patched")));
+
+        QFile shared(m_dir.filePath("1.TRLE/tomb4.exe"));
+        QVERIFY(shared.open(QIODevice::ReadOnly));
+        QCOMPARE(shared.readAll(), m_exe);
+    }
+
+    void collectGarbage() {
+        FileStore store(m_dir.filePath(".store"));
+        QVERIFY(QDir(m_dir.filePath("1.TRLE")).removeRecursively());
+        QCOMPARE(store.collectGarbage().files, qint64(0));
+        QVERIFY(QDir(m_dir.filePath("3.TRLE")).removeRecursively());
+        const FileStore::Stats freed = store.collectGarbage();
+        QCOMPARE(freed.files, qint64(1));
+        QCOMPARE(freed.bytes, quint64(m_exe.size()));
+        QCOMPARE(store.report().files, qint64(0));
+    }
+
+ private:
+    ino_t inode(const QString& name) const {
+        struct stat st = {};
+        (void)lstat(QFile::encodeName(m_dir.filePath(name)).constData(), &st);
+        return st.st_ino;
+    }
+
+    QTemporaryDir m_dir;
+    QByteArray m_exe;
+};
+
+class FileHashTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void initTestCase() {
+        QVERIFY(m_dir.isValid());
+        Path::setTestProgramFilesPath();
+        Path::setTestResourcePath();
+        QVERIFY(Data::getInstance().initializeDatabase());
+    }
+
+    void secondGetIsHit() {
+        const QString path = m_dir.filePath("tomb4.exe");
+        QVERIFY(writeTestFile(path, QByteArray(64 * 1024, 'x')));
+        FileHash& cache = FileHash::getInstance();
+        const qint64 hits = cache.getHits();
+
+        const FileHash::Sums first = cache.get(path);
+        QCOMPARE(first.md5, QString(QCryptographicHash::hash(
+            QByteArray(64 * 1024, 'x'), QCryptographicHash::Md5).toHex()));
+        QCOMPARE(cache.getHits(), hits);
+        const FileHash::Sums second = cache.get(path);
+        QCOMPARE(cache.getHits(), hits + 1);
+        QCOMPARE(second.md5, first.md5);
+        QCOMPARE(second.blake2b, first.blake2b);
+    }
+
+    void changedFileIsMiss() {
+        const QString path = m_dir.filePath("tomb4.exe");
+        const FileHash::Sums before = FileHash::getInstance().get(path);
+        QVERIFY(writeTestFile(path, QByteArray("patched")));
+        const qint64 misses = FileHash::getInstance().getMisses();
+        const FileHash::Sums after = FileHash::getInstance().get(path);
+        QCOMPARE(FileHash::getInstance().getMisses(), misses + 1);
+        QVERIFY(after.md5 != before.md5);
+    }
+
+ private:
+    QTemporaryDir m_dir;
+};
+
+class ProgressTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void phasesFillOneBar() {
+        Progress& progress = Progress::getInstance();
+        progress.reset();
+        QCOMPARE(progress.sample().permille, 0);
+
+        progress.begin(Progress::Phase::Download, 0, 500);
+        QCOMPARE(progress.sample().permille, 0);
+        progress.update(50, 100);
+        QCOMPARE(progress.sample().permille, 250);
+
+        progress.begin(Progress::Phase::Extract, 500, 1000);
+        QCOMPARE(progress.sample().permille, 500);
+        progress.update(300, 400);
+        const Progress::Sample sample = progress.sample();
+        QCOMPARE(sample.phase, Progress::Phase::Extract);
+        QCOMPARE(sample.permille, 875);
+
+        progress.finish();
+        QCOMPARE(progress.sample().permille, 1000);
+    }
+
+    void updatesFromWorkers() {
+        Progress& progress = Progress::getInstance();
+        progress.begin(Progress::Phase::Copy, 0, 1000);
+        QThreadPool pool;
+        for (int i = 0; i < 4; i++) {
+            pool.start([&progress, i]() {
+                progress.update((i + 1) * 100, 400);
+            });
+        }
+        pool.waitForDone();
+        const Progress::Sample sample = progress.sample();
+        QVERIFY(sample.done <= sample.total);
+        QVERIFY(sample.permille >= 250 && sample.permille <= 1000);
+        progress.fail();
+        QCOMPARE(progress.sample().permille, 0);
+    }
+};
+
+class TrashReaperTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void initTestCase() {
+        QVERIFY(m_dir.isValid());
+    }
+
+    void reapsLeftoverTrash() {
+        // Left by a run that ended while reaping
+        QVERIFY(writeTree(".trash/1-0-7.TRLE"));
+        QSignalSpy spy(&TrashReaper::getInstance(),
+            &TrashReaper::spaceFreedSignal);
+        TrashReaper::getInstance().start(m_dir.filePath(".trash"), QString());
+        QVERIFY(spy.wait(5000));
+        QVERIFY(spy.takeFirst().at(0).toULongLong() > 0);
+        QVERIFY(QDir(m_dir.filePath(".trash")).isEmpty());
+    }
+
+    void trashIsOneRename() {
+        QVERIFY(writeTree("8.TRLE"));
+        QSignalSpy spy(&TrashReaper::getInstance(),
+            &TrashReaper::spaceFreedSignal);
+        QVERIFY(TrashReaper::getInstance().trash(m_dir.filePath("8.TRLE")));
+        QVERIFY(!QFileInfo::exists(m_dir.filePath("8.TRLE")));
+        QVERIFY(spy.count() > 0 || spy.wait(5000));
+        QVERIFY(QDir(m_dir.filePath(".trash")).isEmpty());
+    }
+
+ private:
+    bool writeTree(const QString& name) {
+        bool status = true;
+        for (int i = 0; (i < 600) && (status == true); i++) {
+            const QString path = m_dir.filePath(
+                QString("%1/DATA%2/%3.tr4").arg(name).arg(i % 3).arg(i));
+            status = writeTestFile(path, QByteArray(8192, 'l'));
+        }
+        return status;
+    }
+
+    QTemporaryDir m_dir;
+};
+
+class SaveStoreTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void initTestCase() {
+        QVERIFY(m_dir.isValid());
+        QVERIFY(writeTestFile(saves()[0], QByteArray(16 * 1024, 'a')));
+        QVERIFY(writeTestFile(saves()[1], QByteArray(16 * 1024, 'b')));
+    }
+
+    void unchangedIsSkipped() {
+        SaveStore store(m_dir.filePath(".saves"), m_dir.filePath("level"));
+        qint64 id = 0;
+        QCOMPARE(store.snapshot(saves(), &id), 0);
+        QCOMPARE(store.snapshot(saves()), 1);
+        QCOMPARE(store.list(), QVector<qint64>() << id);
+    }
+
+    void changedSaveSharesObjects() {
+        SaveStore store(m_dir.filePath(".saves"), m_dir.filePath("level"));
+        QVERIFY(writeTestFile(saves()[1], QByteArray(16 * 1024, 'c')));
+        QCOMPARE(store.snapshot(saves()), 0);
+        QCOMPARE(store.list().size(), 2);
+        // savegame.0 is stored once for both snapshots
+        QCOMPARE(objectCount(), 3);
+    }
+
+    void restoreOldSnapshot() {
+        SaveStore store(m_dir.filePath(".saves"), m_dir.filePath("level"));
+        QVERIFY(store.restore(store.list().first()));
+        QFile save(m_dir.filePath("level/savegame.1"));
+        QVERIFY(save.open(QIODevice::ReadOnly));
+        QCOMPARE(save.readAll(), QByteArray(16 * 1024, 'b'));
+        // A new snapshot, but its contents are all stored already
+        QCOMPARE(store.snapshot(saves()), 0);
+        QCOMPARE(objectCount(), 3);
+        QCOMPARE(store.snapshot(saves()), 1);
+    }
+
+    void pruneDropsUnusedObjects() {
+        SaveStore store(m_dir.filePath(".saves"), m_dir.filePath("level"));
+        QVERIFY(writeTestFile(saves()[1], QByteArray(16 * 1024, 'd')));
+        QCOMPARE(store.snapshot(saves()), 0);
+        QCOMPARE(store.prune(1, 0), qint64(3));
+        QCOMPARE(store.list().size(), 1);
+        QCOMPARE(objectCount(), 2);
+    }
+
+    void restoreOldestKept() {
+        SaveStore store(m_dir.filePath(".saves"), m_dir.filePath("level"));
+        for (const char c : {'e', 'f', 'g'}) {
+            QVERIFY(writeTestFile(saves()[1], QByteArray(16 * 1024, c)));
+            QCOMPARE(store.snapshot(saves()), 0);
+        }
+        QVERIFY(store.prune(3, 0) > 0);
+        const qint64 oldest = store.list().first();
+
+        // The snapshot of the changed saves is taken before the restore
+        QVERIFY(writeTestFile(saves()[1], QByteArray(16 * 1024, 'h')));
+        QVERIFY(store.restore(oldest, saves()));
+        QFile save(m_dir.filePath("level/savegame.1"));
+        QVERIFY(save.open(QIODevice::ReadOnly));
+        QCOMPARE(save.readAll(), QByteArray(16 * 1024, 'e'));
+        QCOMPARE(store.list().size(), 4);
+        QCOMPARE(store.list().first(), oldest);
+
+        // Pruned only after the restore, as Model does
+        QCOMPARE(store.prune(3, 0), qint64(1));
+        QVERIFY(!store.list().contains(oldest));
+    }
+
+ private:
+    QStringList saves() const {
+        return QStringList() << m_dir.filePath("level/savegame.0")
+                             << m_dir.filePath("level/savegame.1");
+    }
+
+    int objectCount() const {
+        int count = 0;
+        QDirIterator it(m_dir.filePath(".saves/objects"), QDir::Files,
+            QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            count++;
+        }
+        return count;
+    }
+
+    QTemporaryDir m_dir;
+};
+
 #endif  // TEST_TEST_HPP_